@@ -0,0 +1,106 @@
+/* GPLv2 (c) Airbus */
+#include <console.h>
+#include <uart.h>
+#include <debugcon.h>
+#include <string.h>
+#include <pagemem.h>
+
+static int __debugcon_probe()
+{
+   return debugcon_present() ? 0 : -1;
+}
+
+static console_t consoles[] = {
+   { "uart",     0,                 uart_write,     uart_sync, uart_flush },
+   { "debugcon", __debugcon_probe,  debugcon_write, 0,         0          },
+};
+
+#define CONSOLE_NR              (sizeof(consoles)/sizeof(consoles[0]))
+
+/* usable before console_init() */
+console_t *console = &consoles[0];
+
+static int __console_prefix(char *s, char *prefix)
+{
+   while(*prefix)
+      if(*s++ != *prefix++)
+         return 0;
+
+   return 1;
+}
+
+/*
+** Option values end at a blank or at the end of line
+*/
+static int __console_match(char *name, char *opt)
+{
+   size_t len = strlen(name);
+
+   return __console_prefix(opt, name) && (!opt[len] || opt[len] == ' ');
+}
+
+int console_select(char *name)
+{
+   size_t i;
+
+   for(i=0 ; i<CONSOLE_NR ; i++)
+   {
+      if(!__console_match(consoles[i].name, name))
+         continue;
+
+      if(consoles[i].probe && consoles[i].probe() < 0)
+         return -1;
+
+      console = &consoles[i];
+      return 0;
+   }
+
+   return -1;
+}
+
+/*
+** Look for CONSOLE_OPT in the multiboot command line
+*/
+static char* __console_cmdline(mbi_t *mbi)
+{
+   char *start, *s;
+
+   if(!mbi || !(mbi->flags & MBI_FLAG_CMDLINE) || !mbi->cmdline)
+      return 0;
+
+   start = (char*)__va(mbi->cmdline);
+   for(s=start ; *s ; s++)
+      if((s == start || s[-1] == ' ') && __console_prefix(s, CONSOLE_OPT))
+         return s + sizeof(CONSOLE_OPT) - 1;
+
+   return 0;
+}
+
+void console_init(mbi_t *mbi)
+{
+   char *opt = __console_cmdline(mbi);
+
+   if(opt && console_select(opt) == 0)
+      return;
+
+#ifdef CONFIG_DEBUGCON
+   console_select("debugcon");
+#endif
+}
+
+size_t console_write(uint8_t *data, size_t n)
+{
+   return console->write(data, n);
+}
+
+void console_sync()
+{
+   if(console->sync)
+      console->sync();
+}
+
+void console_flush()
+{
+   if(console->flush)
+      console->flush();
+}
@@ -0,0 +1,86 @@
+/* GPLv2 (c) Airbus */
+#include <cpu.h>
+#include <debug.h>
+#include <string.h>
+
+static char *cpu_feat_names[] = {
+   "tsc", "pse", "pge", "apic", "sep", "fxsr",
+   "sse", "sse2", "erms", "invtsc", "hypervisor",
+};
+
+#define CPU_NR_FEATS  (sizeof(cpu_feat_names)/sizeof(cpu_feat_names[0]))
+
+#define __cpu_set(_f_,_c_)                              \
+   ({ if(_c_) info->cpu.features |= 1<<(_f_); })
+
+/*
+** Run at start() before anything depends on a feature:
+** no output here, see cpu_print()
+*/
+void cpu_init()
+{
+   cpu_info_t *cpu = &info->cpu;
+   uint32_t   a, b, c, d;
+
+   cpuid(0, a, b, c, d);
+   cpu->max_leaf = a;
+   memcpy(&cpu->vendor[0], &b, 4);
+   memcpy(&cpu->vendor[4], &d, 4);
+   memcpy(&cpu->vendor[8], &c, 4);
+   cpu->vendor[12] = 0;
+
+   if(cpu->max_leaf < 1)
+      return;
+
+   cpuid(1, a, b, c, d);
+   cpu->stepping = a & 0xf;
+   cpu->model    = (a >> 4) & 0xf;
+   cpu->family   = (a >> 8) & 0xf;
+   if(cpu->family == 0xf)
+      cpu->family += (a >> 20) & 0xff;
+   if(cpu->family >= 6)
+      cpu->model  |= ((a >> 16) & 0xf) << 4;
+
+   __cpu_set(CPU_TSC,        d & CPUID_EDX_TSC);
+   __cpu_set(CPU_PSE,        d & CPUID_EDX_PSE);
+   __cpu_set(CPU_PGE,        d & CPUID_EDX_PGE);
+   __cpu_set(CPU_APIC,       d & CPUID_EDX_APIC);
+   __cpu_set(CPU_FXSR,       d & CPUID_EDX_FXSR);
+   __cpu_set(CPU_SSE,        d & CPUID_EDX_SSE);
+   __cpu_set(CPU_SSE2,       d & CPUID_EDX_SSE2);
+   __cpu_set(CPU_HYPERVISOR, c & CPUID_ECX_HYPERVISOR);
+
+   /* Pentium Pro (6, model < 3, stepping < 3) reports SEP wrongly */
+   __cpu_set(CPU_SEP, (d & CPUID_EDX_SEP) &&
+             !(cpu->family == 6 && cpu->model < 3 && cpu->stepping < 3));
+
+   if(cpu->max_leaf >= 7)
+   {
+      cpuid(7, a, b, c, d);
+      __cpu_set(CPU_ERMS, b & CPUID_EBX_ERMS);
+   }
+
+   cpuid(0x80000000, a, b, c, d);
+   if(a >= 0x80000007)
+   {
+      cpuid(0x80000007, a, b, c, d);
+      __cpu_set(CPU_INVTSC, d & CPUID_EDX_INVTSC);
+   }
+}
+
+void cpu_print()
+{
+   cpu_info_t *cpu = &info->cpu;
+   char       feats[96];
+   size_t     len = 0;
+   uint32_t   i;
+
+   feats[0] = 0;
+   for(i=0 ; i<CPU_NR_FEATS ; i++)
+      if(cpu_has(i))
+         len += snprintf(&feats[len], sizeof(feats)-len,
+                         " %s", cpu_feat_names[i]) - 1;
+
+   debug("cpu: %s family %u model %u stepping %u:%s\n",
+         cpu->vendor, cpu->family, cpu->model, cpu->stepping, feats);
+}
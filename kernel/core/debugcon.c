@@ -0,0 +1,16 @@
+/* GPLv2 (c) Airbus */
+#include <debugcon.h>
+
+/*
+** One string instruction per buffer
+*/
+size_t debugcon_write(uint8_t *data, size_t n)
+{
+   size_t cnt = n;
+
+   asm volatile ("cld ; rep outsb"
+                 :"+S"(data),"+c"(cnt)
+                 :"d"(DEBUGCON_PORT)
+                 :"memory");
+   return n;
+}
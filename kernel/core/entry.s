@@ -3,12 +3,67 @@
 .align 16
 .space 0x2000
 
+/*
+** Boot page directory, only used by higher-half kernels
+** (ie. linked with a non null __kernel_vma__)
+*/
+.section .bss
+.align 4096
+.globl __boot_pgd__
+__boot_pgd__:
+.space 4096
+
 .text
 .globl entry
 .type  entry,"function"
 
+/*
+** Grub jumps here with paging disabled. If the kernel is
+** linked in the higher half, we are running at our physical
+** address and nothing but relative jumps may be used until
+** the boot mapping is installed:
+**
+**  - [0 - 1GB[            identity (4MB pages)
+**  - [vma - vma+1GB[      -> [0 - 1GB[
+**
+** Keep %ebx (mbi) untouched.
+*/
 entry:
         cli
+        movl    $__kernel_vma__, %ecx
+        test    %ecx, %ecx
+        jz      2f
+
+        movl    $__boot_pgd__, %edi
+        subl    %ecx, %edi
+
+        shrl    $22, %ecx
+        shll    $2, %ecx
+        addl    %edi, %ecx                /* kernel pde in boot pgd */
+
+        movl    $0x83, %eax               /* PG_PS|PG_RW|PG_P */
+        xorl    %edx, %edx
+1:
+        movl    %eax, (%edi,%edx,4)
+        movl    %eax, (%ecx,%edx,4)
+        addl    $0x400000, %eax
+        incl    %edx
+        cmpl    $256, %edx
+        jne     1b
+
+        movl    %edi, %cr3
+
+        movl    %cr4, %eax
+        orl     $0x10, %eax               /* CR4_PSE */
+        movl    %eax, %cr4
+
+        movl    %cr0, %eax
+        orl     $0x80000000, %eax         /* CR0_PG */
+        movl    %eax, %cr0
+
+        movl    $2f, %eax
+        jmp     *%eax
+2:
         movl    $__kernel_start__, %esp
         pushl   $0
         popf
@@ -3,6 +3,8 @@
 #include <cr.h>
 #include <debug.h>
 #include <info.h>
+#include <vm.h>
+#include <uaccess.h>
 
 extern info_t *info;
 
@@ -31,6 +33,17 @@ static char* exception_names[] = {
 
 void __regparm__(1) excp_hdlr(int_ctx_t *ctx)
 {
+   if(ctx->nr.blow == PF_EXCP && (vm_fault(ctx) || uaccess_fixup(ctx)))
+      return;
+
+   if(ctx->nr.blow == PF_EXCP && ctx->err.pf.us && excp_user_kill)
+   {
+      debug("#PF user: eip 0x%x addr 0x%x wr:%d\n"
+            ,ctx->eip.raw, get_cr2(), ctx->err.pf.wr);
+      excp_user_kill(ctx);
+   }
+
+   intr_dump(ctx);
    debug("\nException: %s\n", exception_names[ctx->nr.blow]);
 
    switch(ctx->nr.blow)
@@ -60,6 +73,5 @@ void __regparm__(1) excp_hdlr(int_ctx_t *ctx)
 
    debug("cr0 = %p\n", (void*)get_cr0());
    debug("cr4 = %p\n", (void*)get_cr4());
-   stack_trace(ctx->gpr.ebp.raw);
    panic("fatal exception !\n");
 }
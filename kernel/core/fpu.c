@@ -0,0 +1,54 @@
+/* GPLv2 (c) Airbus */
+#include <fpu.h>
+#include <cpu.h>
+#include <cr.h>
+#include <gpr.h>
+#include <asm.h>
+#include <debug.h>
+
+bool_t fpu_sse;
+
+static uint8_t fpu_save[FPU_SAVE_SZ] __attribute__((aligned(16)));
+static ulong_t fpu_flags;
+static bool_t  fpu_busy;
+
+/*
+** x87 native errors, sse enabled with fxsave/fxrstor
+** when the cpu has them
+*/
+void fpu_init()
+{
+   uint32_t cr0 = get_cr0();
+
+   cr0 &= ~(CR0_EM|CR0_TS);
+   cr0 |= CR0_MP|CR0_NE;
+   set_cr0(cr0);
+   asm volatile ("fninit");
+
+   if(!cpu_has(CPU_FXSR) || !cpu_has(CPU_SSE))
+      return;
+
+   set_cr4(get_cr4()|CR4_OSFXSR|CR4_OSXMMEXCPT);
+   fpu_sse = true;
+}
+
+void fpu_begin()
+{
+   if(!fpu_sse)
+      panic("fpu section without sse\n");
+
+   disable_interrupts(fpu_flags);
+
+   if(fpu_busy)
+      panic("nested fpu section\n");
+
+   fpu_busy = true;
+   asm volatile ("fxsave %0"::"m"(fpu_save):"memory");
+}
+
+void fpu_end()
+{
+   asm volatile ("fxrstor %0"::"m"(fpu_save):"memory");
+   fpu_busy = false;
+   restore_interrupts(fpu_flags);
+}
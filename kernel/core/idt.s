@@ -38,6 +38,7 @@ eoi_pic1:
 */
 idt_common:
         pusha
+        cld
         mov     %esp, %eax
         call    intr_hdlr
 
@@ -2,11 +2,24 @@
 #include <intr.h>
 #include <debug.h>
 #include <info.h>
+#include <pic.h>
+#include <ksym.h>
 
 extern info_t *info;
 extern void idt_trampoline();
 static int_desc_t IDT[IDT_NR_DESC];
 
+/*
+** Device handlers, indexed by PIC irq line
+*/
+static isr_t irq_hdlrs[PIC_IRQ_NR];
+
+void intr_irq_register(uint8_t irq, isr_t hdlr)
+{
+   if(irq < PIC_IRQ_NR)
+      irq_hdlrs[irq] = hdlr;
+}
+
 void intr_init()
 {
    idt_reg_t idtr;
@@ -24,8 +37,11 @@ void intr_init()
    set_idtr(idtr);
 }
 
-void __regparm__(1) intr_hdlr(int_ctx_t *ctx)
+void intr_dump(int_ctx_t *ctx)
 {
+   char     name[KSYM_NAME_MAX];
+   offset_t off;
+
    debug("\nIDT event\n"
          " . int    #%d\n"
          " . error  0x%x\n"
@@ -54,10 +70,22 @@ void __regparm__(1) intr_hdlr(int_ctx_t *ctx)
          ,ctx->gpr.esi.raw
          ,ctx->gpr.edi.raw);
 
+   if(!ksym_lookup(ctx->eip.raw, name, sizeof(name), &off))
+      debug("eip     : %s+0x%lx\n", name, off);
+}
+
+void __regparm__(1) intr_hdlr(int_ctx_t *ctx)
+{
    uint8_t vector = ctx->nr.blow;
 
    if(vector < NR_EXCP)
       excp_hdlr(ctx);
+   else if(vector >= PIC_IRQ_BASE && vector < PIC_IRQ_BASE+PIC_IRQ_NR &&
+           irq_hdlrs[vector - PIC_IRQ_BASE])
+      irq_hdlrs[vector - PIC_IRQ_BASE](ctx);
    else
+   {
+      intr_dump(ctx);
       debug("ignore IRQ %d\n", vector);
+   }
 }
@@ -0,0 +1,211 @@
+/* GPLv2 (c) Airbus */
+#include <ipc.h>
+#include <pmem.h>
+#include <uaccess.h>
+#include <debug.h>
+
+ipc_chan_t ipc_chans[IPC_NR_CHAN];
+
+/*
+** Kernel frames hold a copy of the payload, the
+** sender address space must be the current one
+*/
+static int __ipc_send_copy(ipc_msg_t *msg, offset_t va)
+{
+   size_t i, len = msg->len;
+
+   for(i=0 ; i<msg->nr_pages ; i++)
+   {
+      size_t sz = (len < PAGE_SIZE) ? len : PAGE_SIZE;
+
+      msg->frames[i] = pmem_alloc();
+      if(!msg->frames[i])
+      {
+         while(i--)
+            pmem_put(msg->frames[i]);
+
+         return -1;
+      }
+
+      if(copy_from_user(__va(msg->frames[i]), (void*)(va + i*PAGE_SIZE), sz))
+      {
+         pmem_put(msg->frames[i]);
+         while(i--)
+            pmem_put(msg->frames[i]);
+
+         return -1;
+      }
+
+      len -= sz;
+   }
+
+   return 0;
+}
+
+/*
+** Payload frames are taken from the sender page tables,
+** TLB shootdown is done once for the whole buffer.
+**
+** Shared pages belong to their shm object (or are the
+** vdso): they are neither moved nor lent.
+*/
+static int __ipc_send_remap(ipc_msg_t *msg, vm_t *vm, offset_t va)
+{
+   bool_t lend = (msg->flags & IPC_LEND) ? true : false;
+   size_t i;
+
+   for(i=0 ; i<msg->nr_pages ; i++)
+   {
+      pte32_t *pte = vm_get_pte(vm, va + i*PAGE_SIZE);
+
+      if(!pte || !pg_present(pte) || !pte->lvl || (pte->raw & VM_PG_SHR))
+         return -1;
+   }
+
+   for(i=0 ; i<msg->nr_pages ; i++)
+   {
+      pte32_t  *pte = vm_get_pte(vm, va + i*PAGE_SIZE);
+      offset_t pa   = page_get_addr(pte->addr);
+
+      /* frame still referenced elsewhere */
+      if(lend || (pte->raw & VM_PG_COW) || pmem_refs(pa) != 1)
+         msg->attrs[i] = PG_USR|VM_PG_COW;
+      else
+         msg->attrs[i] = PG_USR|PG_RW;
+
+      msg->frames[i] = pa;
+
+      if(!lend)
+         pg_set_zero(pte);
+      else
+      {
+         pmem_get(pa);
+         pte->rw   = 0;
+         pte->raw |= VM_PG_COW;
+      }
+   }
+
+   vm_flush(vm, va, msg->nr_pages);
+   return 0;
+}
+
+int ipc_send(ipc_chan_t *ch, vm_t *vm, offset_t va, size_t len, uint32_t flags)
+{
+   ipc_msg_t *msg;
+   size_t    nr = (len + PAGE_SIZE - 1)/PAGE_SIZE;
+   int       rc;
+
+   if(!nr || nr > IPC_MAX_PAGES || ch->tail - ch->head == IPC_QUEUE_LEN)
+      return -1;
+
+   if(!page_is_aligned(va) || va + nr*PAGE_SIZE <= va ||
+      va + nr*PAGE_SIZE > VM_USER_END)
+      return -1;
+
+   msg = &ch->msg[ch->tail % IPC_QUEUE_LEN];
+   msg->flags    = flags;
+   msg->len      = len;
+   msg->nr_pages = nr;
+
+   if(flags & IPC_COPY)
+      rc = (vm == vm_current) ? __ipc_send_copy(msg, va) : -1;
+   else
+      rc = __ipc_send_remap(msg, vm, va);
+
+   if(rc < 0)
+      return -1;
+
+   ch->tail++;
+   return 0;
+}
+
+/*
+** Dequeue a message into vm at va (kernel chosen if null),
+** return the payload address or 0 if the channel is empty.
+** Copied payloads need a destination buffer in the current
+** address space.
+*/
+offset_t ipc_recv(ipc_chan_t *ch, vm_t *vm, offset_t va, size_t *len)
+{
+   ipc_msg_t *msg;
+   size_t    i;
+
+   if(ch->tail == ch->head)
+      return 0;
+
+   msg = &ch->msg[ch->head % IPC_QUEUE_LEN];
+
+   if(msg->flags & IPC_COPY)
+   {
+      size_t left = msg->len;
+
+      if(vm != vm_current || !va || !uaccess_ok(va, msg->len))
+         return 0;
+
+      for(i=0 ; i<msg->nr_pages ; i++)
+      {
+         size_t sz = (left < PAGE_SIZE) ? left : PAGE_SIZE;
+
+         if(copy_to_user((void*)(va + i*PAGE_SIZE), __va(msg->frames[i]), sz))
+            return 0;
+
+         left -= sz;
+      }
+
+      for(i=0 ; i<msg->nr_pages ; i++)
+         pmem_put(msg->frames[i]);
+   }
+   else
+   {
+      if(!va)
+         va = vm_find_free(vm, IPC_VA_START, IPC_VA_END, msg->nr_pages*PAGE_SIZE);
+      else if(!vm_range_free(vm, va, msg->nr_pages*PAGE_SIZE))
+         return 0;
+
+      if(!va)
+         return 0;
+
+      for(i=0 ; i<msg->nr_pages ; i++)
+         if(vm_map(vm, va + i*PAGE_SIZE, msg->frames[i], msg->attrs[i]) < 0)
+         {
+            while(i--)
+               vm_unmap(vm, va + i*PAGE_SIZE);
+
+            return 0;
+         }
+   }
+
+   *len = msg->len;
+   ch->head++;
+   return va;
+}
+
+/*
+** Give back a payload received by page remapping: len
+** bytes at va, outside of any region and not shared
+*/
+int ipc_unmap(vm_t *vm, offset_t va, size_t len)
+{
+   size_t i, nr = (len + PAGE_SIZE - 1)/PAGE_SIZE;
+
+   if(!nr || !page_is_aligned(va) || va + nr*PAGE_SIZE <= va ||
+      va + nr*PAGE_SIZE > VM_USER_END)
+      return -1;
+
+   for(i=0 ; i<vm->nr_rgn ; i++)
+      if(va < vm->rgn[i].end && vm->rgn[i].start < va + nr*PAGE_SIZE)
+         return -1;
+
+   for(i=0 ; i<nr ; i++)
+   {
+      pte32_t *pte = vm_get_pte(vm, va + i*PAGE_SIZE);
+
+      if(!pte || !pg_present(pte) || !pte->lvl || (pte->raw & VM_PG_SHR))
+         return -1;
+   }
+
+   for(i=0 ; i<nr ; i++)
+      pmem_put(vm_unmap(vm, va + i*PAGE_SIZE));
+
+   return 0;
+}
@@ -0,0 +1,97 @@
+/* GPLv2 (c) Airbus */
+#include <ksym.h>
+
+/*
+** Weak: null until the second link provides the table,
+** addresses are 32 bits wide (ksymgen.py)
+*/
+extern const uint32_t __ksym_nr__      __attribute__((weak));
+extern const uint32_t __ksym_addr__[]  __attribute__((weak));
+extern const uint32_t __ksym_block__[] __attribute__((weak));
+extern const uint8_t  __ksym_names__[] __attribute__((weak));
+
+/*
+** Rebuild the name of entry i from its block start
+*/
+static size_t __ksym_decode(int i, char *name)
+{
+   const uint8_t *p = &__ksym_names__[__ksym_block__[i/KSYM_BLOCK]];
+   size_t        len = 0;
+   int           j;
+
+   for(j=i & ~(KSYM_BLOCK-1) ; j<=i ; j++, p++)
+   {
+      for(len=*p++ ; *p && len < KSYM_NAME_MAX-1 ; )
+         name[len++] = *p++;
+
+      /* name cut at KSYM_NAME_MAX-1 */
+      while(*p)
+         p++;
+   }
+
+   name[len] = 0;
+   return len;
+}
+
+/*
+** Index of the symbol holding addr, -1 outside
+** of the code sections
+*/
+int ksym_find(offset_t addr)
+{
+   char     name[KSYM_NAME_MAX];
+   uint32_t lo, hi, mid;
+
+   if(!&__ksym_nr__ || !__ksym_nr__ || addr < __ksym_addr__[0])
+      return -1;
+
+   /* __ksym_addr__[lo] <= addr < __ksym_addr__[hi] */
+   lo = 0;
+   hi = __ksym_nr__;
+   while(hi - lo > 1)
+   {
+      mid = (lo + hi)/2;
+      if(__ksym_addr__[mid] <= addr)
+         lo = mid;
+      else
+         hi = mid;
+   }
+
+   if(!__ksym_decode(lo, name))
+      return -1;
+
+   return lo;
+}
+
+offset_t ksym_addr(int i)
+{
+   return __ksym_addr__[i];
+}
+
+size_t ksym_name(int i, char *name, size_t len)
+{
+   char   full[KSYM_NAME_MAX];
+   size_t n, k;
+
+   n = __ksym_decode(i, full);
+   if(!len)
+      return n;
+
+   for(k=0 ; k<n && k<len-1 ; k++)
+      name[k] = full[k];
+
+   name[k] = 0;
+   return n;
+}
+
+int ksym_lookup(offset_t addr, char *name, size_t len, offset_t *off)
+{
+   int i = ksym_find(addr);
+
+   if(i < 0)
+      return -1;
+
+   ksym_name(i, name, len);
+   *off = addr - __ksym_addr__[i];
+   return 0;
+}
@@ -0,0 +1,222 @@
+/* GPLv2 (c) Airbus */
+#include <log.h>
+#include <console.h>
+#include <asm.h>
+#include <cpu.h>
+
+log_stats_t              log_stats;
+uint32_t                 log_level = LOG_DEBUG;
+
+static log_rec_t         log_ring[LOG_NR_RECORDS];
+static volatile uint32_t log_head;       /* next sequence number */
+static volatile uint32_t log_tail;       /* next record to flush */
+static volatile uint32_t log_flushing;
+static volatile bool_t   log_deferred;
+
+/*
+** Reserve the next sequence number, fails when
+** the ring is full of unflushed records
+*/
+static int __log_reserve(uint32_t *seq)
+{
+   uint32_t head;
+
+   do
+   {
+      head = log_head;
+      if(head - log_tail >= LOG_NR_RECORDS)
+         return -1;
+
+   } while(cmpxchg(&log_head, head, head+1) != head);
+
+   *seq = head;
+   return 0;
+}
+
+/*
+** "#L seq tsc id words..." in hex, no division
+*/
+static char* __log_hex(char *p, uint32_t v)
+{
+   static char hex[] = "0123456789abcdef";
+   int i;
+
+   *p++ = ' ';
+   for(i=28 ; i>=0 ; i-=4)
+      *p++ = hex[(v>>i) & 0xf];
+
+   return p;
+}
+
+static void __log_write_fast(log_rec_t *rec)
+{
+   char     line[sizeof(LOG_FAST_TAG) + (4+LOG_FAST_WORDS)*9 + 1];
+   char     *p = line;
+   uint32_t i;
+
+   for(i=0 ; i<sizeof(LOG_FAST_TAG)-1 ; i++)
+      *p++ = LOG_FAST_TAG[i];
+
+   p = __log_hex(p, rec->seq);
+   p = __log_hex(p, (uint32_t)(rec->tsc >> 32));
+   p = __log_hex(p, (uint32_t)rec->tsc);
+   p = __log_hex(p, rec->fast.fmt);
+   for(i=0 ; i<rec->len ; i++)
+      p = __log_hex(p, rec->fast.args[i]);
+   *p++ = '\n';
+
+   console_write((uint8_t*)line, p - line);
+}
+
+/*
+** Single flusher: a writer interrupting the flusher
+** leaves its record for it. Unless forced, stop at
+** the first record still being written.
+*/
+static void __log_flush(bool_t force)
+{
+   log_rec_t *rec;
+
+   if(xchg(&log_flushing, 1))
+      return;
+
+   while(log_tail != log_head)
+   {
+      rec = &log_ring[log_tail & (LOG_NR_RECORDS-1)];
+      if(rec->done != log_tail+1)
+      {
+         if(!force)
+            break;
+      }
+      else if(rec->level > log_level)
+         log_stats.filtered++;
+      else if(rec->flags & LOG_REC_FAST)
+         __log_write_fast(rec);
+      else
+         console_write((uint8_t*)rec->msg, rec->len);
+
+      barrier();
+      log_tail++;
+   }
+
+   barrier();
+   log_flushing = 0;
+}
+
+void log_flush()
+{
+   __log_flush(false);
+}
+
+size_t log_vprintf(uint32_t level, const char *format, va_list params)
+{
+   log_rec_t *rec;
+   uint32_t   seq;
+   size_t     retval;
+
+   if(__log_reserve(&seq) < 0)
+   {
+      log_flush();
+      if(__log_reserve(&seq) < 0)
+      {
+         log_stats.dropped++;
+         return 0;
+      }
+   }
+
+   rec = &log_ring[seq & (LOG_NR_RECORDS-1)];
+   rec->seq   = seq;
+   rec->level = level;
+   rec->flags = 0;
+   rec->tsc   = cpu_rdtsc();
+
+   retval   = __vsnprintf(rec->msg, sizeof(rec->msg), format, params);
+   rec->len = retval - 1;
+
+   barrier();
+   rec->done = seq+1;
+   log_stats.written++;
+
+   if(!log_deferred)
+      log_flush();
+
+   return retval;
+}
+
+/*
+** Reached through log_fast(): no formatting, the
+** words are copied as pushed by the caller
+*/
+void __log_fast(offset_t fmt, uint32_t words, ...)
+{
+   log_rec_t *rec;
+   va_list    params;
+   uint32_t   seq, i;
+
+   if(__log_reserve(&seq) < 0)
+   {
+      log_flush();
+      if(__log_reserve(&seq) < 0)
+      {
+         log_stats.dropped++;
+         return;
+      }
+   }
+
+   if(words > LOG_FAST_WORDS)
+      words = LOG_FAST_WORDS;
+
+   rec = &log_ring[seq & (LOG_NR_RECORDS-1)];
+   rec->seq      = seq;
+   rec->level    = LOG_INFO;
+   rec->flags    = LOG_REC_FAST;
+   rec->len      = words;
+   rec->tsc      = cpu_rdtsc();
+   rec->fast.fmt = fmt;
+
+   va_start(params, words);
+   for(i=0 ; i<words ; i++)
+      rec->fast.args[i] = va_arg(params, uint32_t);
+   va_end(params);
+
+   barrier();
+   rec->done = seq+1;
+   log_stats.written++;
+
+   if(!log_deferred)
+      log_flush();
+}
+
+size_t log_printf(uint32_t level, const char *format, ...)
+{
+   va_list params;
+   size_t  retval;
+
+   va_start(params, format);
+   retval = log_vprintf(level, format, params);
+   va_end(params);
+
+   return retval;
+}
+
+/*
+** Leave flushing to log_flush() calls (idle, timer tick)
+*/
+void log_defer(bool_t on)
+{
+   log_deferred = on;
+   if(!on)
+      log_flush();
+}
+
+/*
+** Synchronous output from now on, interrupts disabled
+** (panic): the flusher and the writers it waits for may
+** have been interrupted for good
+*/
+void log_sync()
+{
+   log_deferred = false;
+   log_flushing = 0;
+   __log_flush(true);
+}
@@ -0,0 +1,40 @@
+/* GPLv2 (c) Airbus */
+#include <pagemem.h>
+#include <fpu.h>
+#include <cpu.h>
+
+bool_t page_nt;
+
+/*
+** Once fpu_init() enabled sse
+*/
+void page_init()
+{
+   page_nt = (fpu_sse && cpu_has(CPU_SSE2)) ? true : false;
+}
+
+void page_clear(void *pg)
+{
+   if(!page_nt)
+   {
+      __clear_page(pg);
+      return;
+   }
+
+   fpu_begin();
+   __clear_page_nt(pg);
+   fpu_end();
+}
+
+void page_copy(void *dst, void *src)
+{
+   if(!page_nt)
+   {
+      __copy_page(dst, src);
+      return;
+   }
+
+   fpu_begin();
+   __copy_page_nt(dst, src);
+   fpu_end();
+}
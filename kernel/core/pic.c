@@ -22,10 +22,10 @@ void pic_init()
    **  - remap IRQ[00-07] to IDT[32-39]
    **  - remap IRQ[08-15] to IDT[40-47]
    */
-   icw2.raw = 32;
+   icw2.raw = PIC_IRQ_BASE;
    out(icw2.raw, PIC_ICW2(PIC1));
 
-   icw2.raw = 32+8;
+   icw2.raw = PIC_IRQ_BASE+8;
    out(icw2.raw, PIC_ICW2(PIC2));
 
    /*
@@ -0,0 +1,196 @@
+/* GPLv2 (c) Airbus */
+#include <pmem.h>
+#include <pagemem.h>
+#include <debug.h>
+#include <info.h>
+
+extern info_t *info;
+
+/*
+** Frames are first taken from a bump pointer, then
+** recycled through a free list linked inside the
+** free frames themselves.
+*/
+static offset_t pmem_next;
+static offset_t pmem_end;
+static offset_t pmem_list;
+static size_t   pmem_free_cnt;
+static uint16_t pmem_ref[PMEM_NR_FRAMES];
+
+static offset_t         pmem_zero[PMEM_ZERO_HIGH];
+static size_t           pmem_zero_cnt;
+static bool_t           pmem_zero_low;
+static pmem_zero_stat_t pmem_zero_stats;
+
+static void pmem_zero_fill(size_t);
+
+void pmem_init()
+{
+   mbi_t *mbi = info->mbi;
+
+   pmem_next = PMEM_START;
+   pmem_end  = PMEM_START + PMEM_NR_FRAMES*PAGE_SIZE;
+   pmem_list = 0;
+
+   if(mbi && (mbi->flags & MBI_FLAG_MEM))
+   {
+      offset_t top = page_align((mbi->mem_upper + 1024UL)*1024UL);
+
+      if(top < pmem_end)
+         pmem_end = top;
+   }
+
+   if(pmem_end <= pmem_next)
+      panic("not enough memory for frame allocator\n");
+
+   pmem_free_cnt = (pmem_end - pmem_next)/PAGE_SIZE;
+   debug("pmem [0x%lx - 0x%lx] %lu frames\n", pmem_next, pmem_end, pmem_free_cnt);
+
+   pmem_zero_cnt = 0;
+   pmem_zero_fill(PMEM_ZERO_HIGH);
+}
+
+/*
+** Frames of the zero pool are already counted as allocated
+*/
+static offset_t __pmem_alloc()
+{
+   offset_t pa;
+
+   if(pmem_list)
+   {
+      pa = pmem_list;
+      pmem_list = *(offset_t*)__va(pa);
+   }
+   else if(pmem_next < pmem_end)
+   {
+      pa = pmem_next;
+      pmem_next += PAGE_SIZE;
+   }
+   else
+      return 0;
+
+   pmem_ref[pmem_frame_idx(pa)] = 1;
+   pmem_free_cnt--;
+   return pa;
+}
+
+static void pmem_zero_fill(size_t nr)
+{
+   offset_t pa;
+
+   while(nr-- && pmem_zero_cnt < PMEM_ZERO_HIGH && (pa = __pmem_alloc()))
+   {
+      page_clear(__va(pa));
+      pmem_zero[pmem_zero_cnt++] = pa;
+      pmem_zero_stats.filled++;
+   }
+
+   pmem_zero_low = (pmem_zero_cnt < PMEM_ZERO_HIGH && pmem_free_cnt);
+}
+
+offset_t pmem_alloc()
+{
+   offset_t pa = __pmem_alloc();
+
+   if(!pa && pmem_zero_cnt)
+      pa = pmem_zero[--pmem_zero_cnt];
+
+   return pa;
+}
+
+offset_t pmem_alloc_zero()
+{
+   offset_t pa;
+
+   if(pmem_zero_cnt)
+   {
+      pa = pmem_zero[--pmem_zero_cnt];
+      pmem_zero_stats.hit++;
+   }
+   else if((pa = __pmem_alloc()))
+   {
+      page_clear(__va(pa));
+      pmem_zero_stats.miss++;
+   }
+
+   if(pmem_zero_cnt < PMEM_ZERO_LOW)
+      pmem_zero_low = true;
+
+   return pa;
+}
+
+/*
+** Idle work: bounded so that a timer tick stays short
+*/
+void pmem_refill()
+{
+   if(pmem_zero_low)
+      pmem_zero_fill(PMEM_ZERO_BATCH);
+}
+
+/*
+** Physically contiguous frames can only be carved
+** from the never used part of the pool
+*/
+offset_t pmem_alloc_contig(size_t nr)
+{
+   offset_t pa = pmem_next;
+   size_t   i;
+
+   if(!nr || nr > (pmem_end - pmem_next)/PAGE_SIZE)
+      return 0;
+
+   for(i=0 ; i<nr ; i++)
+      pmem_ref[pmem_frame_idx(pa + i*PAGE_SIZE)] = 1;
+
+   pmem_next     += nr*PAGE_SIZE;
+   pmem_free_cnt -= nr;
+   return pa;
+}
+
+void pmem_get(offset_t pa)
+{
+   if(pmem_frame_valid(pa))
+      pmem_ref[pmem_frame_idx(pa)]++;
+}
+
+void pmem_put(offset_t pa)
+{
+   uint16_t *ref;
+
+   if(!pmem_frame_valid(pa))
+      return;
+
+   ref = &pmem_ref[pmem_frame_idx(pa)];
+   if(!*ref)
+      panic("pmem_put: free frame 0x%lx\n", pa);
+
+   if(--(*ref))
+      return;
+
+   pa = page_align(pa);
+   *(offset_t*)__va(pa) = pmem_list;
+   pmem_list = pa;
+   pmem_free_cnt++;
+}
+
+uint32_t pmem_refs(offset_t pa)
+{
+   if(!pmem_frame_valid(pa))
+      return 0;
+
+   return pmem_ref[pmem_frame_idx(pa)];
+}
+
+size_t pmem_nr_free()
+{
+   return pmem_free_cnt;
+}
+
+void pmem_stats()
+{
+   debug("free frames: %lu, zero pool %lu/%u (hit %u, miss %u, filled %u)\n",
+         pmem_free_cnt, pmem_zero_cnt, PMEM_ZERO_HIGH,
+         pmem_zero_stats.hit, pmem_zero_stats.miss, pmem_zero_stats.filled);
+}
@@ -1,22 +1,25 @@
 /* GPLv2 (c) Airbus */
 #include <print.h>
-#include <uart.h>
+#include <console.h>
 #include <string.h>
 #include <asm.h>
-
-static char vprint_buffer[1024];
+#include <log.h>
+#include <debug.h>
 
 void panic(const char *format, ...)
 {
    va_list params;
 
    force_interrupts_off();
+   console_sync();
+   log_sync();
 
    va_start(params, format);
    __vprintf(format, params);
    va_end(params);
 
-   uart_flush();
+   stack_trace((offset_t)__builtin_frame_address(0));
+   console_flush();
    while (1) halt();
 }
 
@@ -47,85 +50,120 @@ size_t snprintf(char *buff, size_t len, const char *format, ...)
 
 size_t __vprintf(const char *format, va_list params)
 {
-   size_t retval;
-
-   retval = __vsnprintf(vprint_buffer,sizeof(vprint_buffer),format,params);
-   uart_write((uint8_t*)vprint_buffer, retval-1);
-   return retval;
+   return log_vprintf(LOG_INFO, format, params);
 }
 
-static inline void __format_add_str(buffer_t *buf, size_t len, char *s)
-{
-   while(*s)
-      __buf_add(buf, len, *s++);
-}
+/*
+** Conversion specification: %[flags][width][.precision][length]conv
+*/
+#define FMT_LEFT        (1<<0)   /* '-' */
+#define FMT_ZERO        (1<<1)   /* '0' */
+#define FMT_PREC        (1<<2)   /* precision given */
 
-static inline void __format_add_chr(buffer_t *buf, size_t len, int c)
+typedef struct format_spec
 {
-   __buf_add(buf, len, (char)c);
+   uint32_t  flags;
+   uint32_t  width;
+   uint32_t  prec;
+   uint32_t  size;               /* integer size in bytes */
+
+} fmt_spec_t;
+
+/*
+** Copy a run of n bytes, truncated to the buffer
+*/
+static inline void __format_add_run(buffer_t *buf, size_t len,
+                                    const char *s, size_t n)
+{
+   if(buf->sz >= len)
+      return;
+
+   if(n > len - buf->sz)
+      n = len - buf->sz;
+
+   memcpy(&buf->data.str[buf->sz], (void*)s, n);
+   buf->sz += n;
 }
 
-static inline void __format_add_bin(buffer_t *buf, size_t len,
-                                    uint64_t value, uint32_t n)
+static inline void __format_add_pad(buffer_t *buf, size_t len,
+                                    char c, size_t n)
 {
-   uint32_t i, bit;
-
-   for(i=0 ; i<n ; i++)
-   {
-      bit = (value >> (n-i-1)) & 1;
-      __buf_add(buf, len, bit?'1':'0');
-   }
+   while(n-- && buf->sz < len)
+      buf->data.str[buf->sz++] = c;
 }
 
-static inline void __format_add_idec(buffer_t *buf, size_t len, sint64_t value)
+/*
+** Emit [sign/prefix][zeros][digits] padded to the field width
+*/
+static void __format_emit(buffer_t *buf, size_t len, fmt_spec_t *spec,
+                          const char *pfx, size_t npfx,
+                          const char *digits, size_t ndigits)
 {
-   char     rep[24];
-   buffer_t dec;
+   size_t zeros = 0, body, pad = 0;
 
-   if(!value)
-      return __buf_add(buf, len, '0');
+   if((spec->flags & FMT_PREC) && spec->prec > ndigits)
+      zeros = spec->prec - ndigits;
 
-   dec.data.str = rep;
-   dec.sz = 0;
+   body = npfx + zeros + ndigits;
+   if(spec->width > body)
+      pad = spec->width - body;
 
-   if(value < 0)
+   if((spec->flags & (FMT_ZERO|FMT_LEFT|FMT_PREC)) == FMT_ZERO)
    {
-      __buf_add(buf, len, '-');
-      value = -value;
+      zeros += pad;
+      pad = 0;
    }
 
-   while(value)
-   {
-      dec.data.str[dec.sz++] = (value%10) + '0';
-      value /= 10;
-   }
+   if(!(spec->flags & FMT_LEFT))
+      __format_add_pad(buf, len, ' ', pad);
+
+   __format_add_run(buf, len, pfx, npfx);
+   __format_add_pad(buf, len, '0', zeros);
+   __format_add_run(buf, len, digits, ndigits);
 
-   while(dec.sz--)
-      __buf_add(buf, len, dec.data.str[dec.sz]);
+   if(spec->flags & FMT_LEFT)
+      __format_add_pad(buf, len, ' ', pad);
 }
 
-static inline void __format_add_udec(buffer_t *buf, size_t len, uint64_t value)
+/*
+** 32 bits decimal conversion: v/10 is (v * 0xcccccccd) >> 35,
+** a single 32x32->64 mul instead of a libgcc division.
+** Digits are written backwards from end, their count is returned.
+*/
+static inline size_t __format_utoa32(uint32_t v, char *end)
 {
-   char     rep[24];
-   buffer_t dec;
+   char     *p = end;
+   uint32_t  q;
+
+   do
+   {
+      q = (uint32_t)(((uint64_t)v * 0xcccccccdU) >> 35);
+      *--p = '0' + (v - q*10);
+      v = q;
+
+   } while(v);
+
+   return end - p;
+}
 
-   if(!value)
-      return __buf_add(buf, len, '0');
+#define FMT_DEC_CHUNK   1000000000U      /* 9 digits per 64 bits step */
 
-   dec.data.str = rep;
-   dec.sz = 0;
+static size_t __format_utoa(uint64_t v, char *end)
+{
+   char   *p = end;
+   size_t  n;
 
-   while(value)
+   while(v >> 32)
    {
-      dec.data.str[dec.sz++] = (value%10) + '0';
-      value /= 10;
+      n = __format_utoa32(div64(&v, FMT_DEC_CHUNK), p);
+      p -= n;
+      while(n++ < 9)
+         *--p = '0';
    }
 
-   while(dec.sz--)
-      __buf_add(buf, len, dec.data.str[dec.sz]);
+   return (end - p) + __format_utoa32((uint32_t)v, p);
 }
 
-
 static char __hextable[] = {'0','1','2','3','4','5','6','7',
                             '8','9','a','b','c','d','e','f'};
 
@@ -153,129 +191,228 @@ size_t uint64_to_hex(buffer_t *buf, size_t len,
    return sz;
 }
 
-static inline void __format_add_hex(buffer_t *buf, size_t len,
-                                    uint64_t value, size_t precision)
+static size_t __format_htoa(uint64_t v, char *end)
 {
-   uint64_to_hex(buf, len, value, precision);
+   char *p = end;
+
+   do
+   {
+      *--p = __hextable[v & 0xf];
+      v >>= 4;
+
+   } while(v);
+
+   return end - p;
 }
 
+static void __format_add_dec(buffer_t *buf, size_t len, fmt_spec_t *spec,
+                             uint64_t value, bool_t neg)
+{
+   char   rep[24];
+   size_t n = 0;
+
+   /* "%.0d" of 0 prints nothing */
+   if(value || !(spec->flags & FMT_PREC) || spec->prec)
+      n = __format_utoa(value, &rep[sizeof(rep)]);
+
+   __format_emit(buf, len, spec, "-", neg ? 1 : 0, &rep[sizeof(rep)-n], n);
+}
+
+static void __format_add_hex(buffer_t *buf, size_t len, fmt_spec_t *spec,
+                             uint64_t value, const char *pfx, size_t npfx)
+{
+   char   rep[16];
+   size_t n = 0;
+
+   /* "%.0x" of 0 prints nothing */
+   if(value || !(spec->flags & FMT_PREC) || spec->prec)
+      n = __format_htoa(value, &rep[sizeof(rep)]);
+
+   __format_emit(buf, len, spec, pfx, npfx, &rep[sizeof(rep)-n], n);
+}
+
+static void __format_add_bin(buffer_t *buf, size_t len, fmt_spec_t *spec,
+                             uint64_t value, uint32_t n)
+{
+   char     rep[64];
+   uint32_t i;
+
+   for(i=0 ; i<n ; i++)
+      rep[i] = ((value >> (n-i-1)) & 1) ? '1' : '0';
+
+   __format_emit(buf, len, spec, 0, 0, rep, n);
+}
+
+static void __format_add_str(buffer_t *buf, size_t len, fmt_spec_t *spec,
+                             const char *s)
+{
+   size_t n = 0;
+
+   if(!s)
+      s = "(null)";
+
+   while(s[n] && (!(spec->flags & FMT_PREC) || n < spec->prec))
+      n++;
+
+   spec->flags &= ~(FMT_PREC|FMT_ZERO);
+   __format_emit(buf, len, spec, 0, 0, s, n);
+}
+
+static inline uint32_t __format_atoi(const char **format)
+{
+   uint32_t v = 0;
+
+   while(**format >= '0' && **format <= '9')
+      v = v*10 + (*(*format)++ - '0');
+
+   return v;
+}
+
+/*
+** Signed/unsigned argument of spec->size bytes
+*/
+#define __format_arg_s(_p_,_spec_)                              \
+   ((_spec_)->size >= 8 ? va_arg(_p_, sint64_t)                 \
+    : (_spec_)->size == 4 ? (sint64_t)va_arg(_p_, sint32_t)     \
+    : (_spec_)->size == 2 ? (sint64_t)(sint16_t)va_arg(_p_, int) \
+    : (sint64_t)(sint8_t)va_arg(_p_, int))
+
+#define __format_arg_u(_p_,_spec_)                              \
+   ((_spec_)->size >= 8 ? va_arg(_p_, uint64_t)                 \
+    : (_spec_)->size == 4 ? (uint64_t)va_arg(_p_, uint32_t)     \
+    : (_spec_)->size == 2 ? (uint64_t)(uint16_t)va_arg(_p_, unsigned int) \
+    : (uint64_t)(uint8_t)va_arg(_p_, unsigned int))
+
 size_t __vsnprintf(char *buffer, size_t len,
                    const char *format, va_list params)
 {
-   buffer_t buf;
-   size_t   size;
-   char     c;
-   bool_t   interp, lng;
+   buffer_t    buf;
+   fmt_spec_t  spec;
+   const char  *run;
+   char        c;
 
    buf.data.str = buffer;
    buf.sz = 0;
-   interp = false;
-   lng = false;
-   size = 4;
 
    if(len) len--;
 
    while(*format)
    {
-      c = *format++;
+      /* literal text up to the next conversion */
+      for(run=format ; *format && *format != '%' ; format++);
+      if(format != run)
+         __format_add_run(&buf, len, run, format - run);
+
+      if(!*format++)
+         break;
+
+      spec.flags = 0;
+      spec.width = 0;
+      spec.prec  = 0;
+      spec.size  = 4;
 
-      if(interp)
+      for( ; ; format++)
       {
-         // length modifiers, may continue to keep 'interp'
-         if(c == 'l'){
-            if(lng)
-               size = 8;
-            else
-               lng = true;
-            continue;
-         } else if(c == 'h'){
-            size /= 2;
-            continue;
-         }
+         if(*format == '-')
+            spec.flags |= FMT_LEFT;
+         else if(*format == '0')
+            spec.flags |= FMT_ZERO;
+         else
+            break;
+      }
 
-         // conversion modifiers
-         if(c == 's'){
-            char* value = va_arg(params, char*);
-            __format_add_str(&buf, len, value);
-         } else if(c == 'c'){
-            int value = va_arg(params, int);
-            __format_add_chr(&buf, len, value);
-         } else if(c == 'b'){
-            uint64_t value = va_arg(params, uint32_t);
-            __format_add_bin(&buf, len, value, 32);
-         } else if(c == 'B'){
-            uint64_t value = va_arg(params, uint64_t);
-            __format_add_bin(&buf, len, value, 64);
-
-            // interpret size length modifier
-         } else if(c == 'd' || c == 'i'){
-            sint64_t value;
-
-            if(size >= 8)
-               value = va_arg(params, sint64_t);
-            else if(size == 4)
-               value = va_arg(params, sint32_t);
-            else if(size == 2)
-               value = (sint16_t)va_arg(params, int);
-            else
-               value = (sint8_t)va_arg(params, int);
+      if(*format == '*')
+      {
+         sint32_t w = va_arg(params, sint32_t);
 
-            __format_add_idec(&buf, len, value);
+         format++;
+         if(w < 0)
+         {
+            spec.flags |= FMT_LEFT;
+            w = -w;
+         }
+         spec.width = w;
+      }
+      else
+         spec.width = __format_atoi(&format);
 
-         } else if(c == 'u' || c == 'x'){
-            uint64_t value;
+      if(*format == '.')
+      {
+         format++;
+         spec.flags |= FMT_PREC;
 
-            if(size >= 8)
-               value = va_arg(params, uint64_t);
-            else if(size == 4)
-               value = va_arg(params, uint32_t);
-            else if(size == 2)
-               value = (uint16_t)va_arg(params, unsigned int);
-            else
-               value = (uint8_t)va_arg(params, unsigned int);
+         if(*format == '*')
+         {
+            sint32_t p = va_arg(params, sint32_t);
 
-            if(c == 'u')
-               __format_add_udec(&buf, len, value);
+            // negative precision is taken as omitted
+            format++;
+            if(p < 0)
+               spec.flags &= ~FMT_PREC;
             else
-               __format_add_hex(&buf, len, value, 0);
-
-            // force size to 64 bits
-         } else if(c == 'D'){
-            sint64_t value = va_arg(params, sint64_t);
-            __format_add_idec(&buf, len, value);
-         } else if(c == 'X'){
-            uint64_t value = va_arg(params, uint64_t);
-            __format_add_hex(&buf, len, value, 0);
-
-            // '0x'%lx
-         } else if(c == 'p'){
-            uint64_t value = va_arg(params, uint32_t);
-            __format_add_str(&buf, len, "0x");
-            __format_add_hex(&buf, len, value, 0);
-
-            // ignore padding, precision ...
-         } else if (c >= '0' && c <= '9') {
-            continue;
-
-            // escaped '%'
-         } else if (c == '%') {
-            __buf_add(&buf, len, c);
-
-            // take care of unsupported format used
-         } else {
-            panic("unsupported format arg '%c'\n", c);
+               spec.prec = p;
          }
-
-         interp = false;
-         lng = false;
+         else
+            spec.prec = __format_atoi(&format);
       }
-      else if(c == '%')
+
+      // length modifiers: 'l' is 32 bits, "ll" 64 bits, 'h' halves
+      if(*format == 'l')
       {
-         interp = true;
-         size = 4;
+         format++;
+         if(*format == 'l')
+         {
+            format++;
+            spec.size = 8;
+         }
       }
       else
+         while(*format == 'h')
+         {
+            format++;
+            spec.size /= 2;
+         }
+
+      c = *format++;
+
+      if(c == 's'){
+         __format_add_str(&buf, len, &spec, va_arg(params, char*));
+      } else if(c == 'c'){
+         char value = (char)va_arg(params, int);
+         spec.flags &= ~(FMT_PREC|FMT_ZERO);
+         __format_emit(&buf, len, &spec, 0, 0, &value, 1);
+      } else if(c == 'b'){
+         __format_add_bin(&buf, len, &spec, va_arg(params, uint32_t), 32);
+      } else if(c == 'B'){
+         __format_add_bin(&buf, len, &spec, va_arg(params, uint64_t), 64);
+      } else if(c == 'd' || c == 'i' || c == 'D'){
+         sint64_t value;
+
+         // 'D' forces 64 bits
+         if(c == 'D')
+            value = va_arg(params, sint64_t);
+         else
+            value = __format_arg_s(params, &spec);
+
+         if(value < 0)
+            __format_add_dec(&buf, len, &spec, -(uint64_t)value, true);
+         else
+            __format_add_dec(&buf, len, &spec, value, false);
+      } else if(c == 'u'){
+         __format_add_dec(&buf, len, &spec, __format_arg_u(params, &spec), false);
+      } else if(c == 'x'){
+         __format_add_hex(&buf, len, &spec, __format_arg_u(params, &spec), 0, 0);
+      } else if(c == 'X'){
+         // 64 bits
+         __format_add_hex(&buf, len, &spec, va_arg(params, uint64_t), 0, 0);
+      } else if(c == 'p'){
+         __format_add_hex(&buf, len, &spec, va_arg(params, uint32_t), "0x", 2);
+      } else if(c == '%'){
          __buf_add(&buf, len, c);
+      } else {
+         // take care of unsupported format used
+         panic("unsupported format arg '%c'\n", c);
+      }
    }
 
    buf.data.str[buf.sz++] = 0;
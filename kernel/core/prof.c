@@ -0,0 +1,153 @@
+/* GPLv2 (c) Airbus */
+#include <prof.h>
+#include <pagemem.h>
+#include <string.h>
+#include <debug.h>
+#include <ksym.h>
+
+/*
+** prof_dump() summary: samples per function holding
+** the pc, PROF_NR_FUNCS distinct ones at most
+*/
+#define PROF_NR_FUNCS          64
+#define PROF_TOP               8
+
+typedef struct prof_func
+{
+   int       sym;
+   uint32_t  count;
+
+} prof_func_t;
+
+volatile uint32_t      prof_enabled;
+
+static prof_sample_t   prof_ring[PROF_RING_LEN];
+static uint32_t        prof_head;             /* next slot, never wraps back */
+
+/*
+** Look for PROF_OPT as a word of the multiboot command line
+*/
+static bool_t __prof_cmdline(mbi_t *mbi)
+{
+   size_t len = sizeof(PROF_OPT) - 1;
+   char   *start, *s;
+
+   if(!mbi || !(mbi->flags & MBI_FLAG_CMDLINE) || !mbi->cmdline)
+      return false;
+
+   start = (char*)__va(mbi->cmdline);
+   for(s=start ; *s ; s++)
+      if((s == start || s[-1] == ' ') && !strncmp(s, PROF_OPT, len) &&
+         (!s[len] || s[len] == ' '))
+         return true;
+
+   return false;
+}
+
+void prof_init(mbi_t *mbi)
+{
+   if(__prof_cmdline(mbi))
+      prof_enable(PROF_ON);
+}
+
+void prof_enable(uint32_t on)
+{
+   prof_enabled = on;
+}
+
+void prof_reset()
+{
+   memset((void*)prof_ring, 0, sizeof(prof_ring));
+   prof_head = 0;
+}
+
+/*
+** Timer interrupt context, "cs" and "ebp" as interrupted
+*/
+void prof_sample(uint32_t pid, offset_t eip, uint32_t cs, offset_t ebp)
+{
+   prof_sample_t *smp = &prof_ring[prof_head++ & (PROF_RING_LEN-1)];
+
+   smp->pid   = pid;
+   smp->cpl   = cs & 3;
+   smp->pc[0] = eip;
+   smp->depth = 1 + stack_walk(ebp, &smp->pc[1], PROF_DEPTH-1);
+}
+
+static void __prof_top(uint32_t first, uint32_t last)
+{
+   static prof_func_t funcs[PROF_NR_FUNCS];
+   char               name[KSYM_NAME_MAX];
+   uint32_t           i, f, nr = 0, other = 0;
+
+   for(i=first ; i<last ; i++)
+   {
+      int sym = ksym_find(prof_ring[i & (PROF_RING_LEN-1)].pc[0]);
+
+      for(f=0 ; f<nr && funcs[f].sym != sym ; f++);
+
+      if(f < nr)
+         funcs[f].count++;
+      else if(nr < PROF_NR_FUNCS)
+      {
+         funcs[nr].sym   = sym;
+         funcs[nr].count = 1;
+         nr++;
+      }
+      else
+         other++;
+   }
+
+   for(i=0 ; i<PROF_TOP && i<nr ; i++)
+   {
+      prof_func_t tmp, *top = &funcs[i];
+
+      for(f=i+1 ; f<nr ; f++)
+         if(funcs[f].count > top->count)
+            top = &funcs[f];
+
+      tmp      = funcs[i];
+      funcs[i] = *top;
+      *top     = tmp;
+
+      if(funcs[i].sym < 0)
+         snprintf(name, sizeof(name), "?");
+      else
+         ksym_name(funcs[i].sym, name, sizeof(name));
+
+      debug("prof: %u %s\n", funcs[i].count, name);
+   }
+
+   if(other)
+      debug("prof: %u in other functions\n", other);
+}
+
+/*
+** Oldest samples first: "#P pid cpl pc caller ..." (hex),
+** one printf() per line, then the busiest functions
+*/
+void prof_dump()
+{
+   char      line[16 + PROF_DEPTH*12];
+   size_t    len;
+   uint32_t  i, d, n, first;
+
+   n     = prof_head < PROF_RING_LEN ? prof_head : PROF_RING_LEN;
+   first = prof_head - n;
+
+   debug("prof: %u samples, last %u:\n", prof_head, n);
+   for(i=first ; i<prof_head ; i++)
+   {
+      prof_sample_t *smp = &prof_ring[i & (PROF_RING_LEN-1)];
+
+      len = snprintf(line, sizeof(line), PROF_TAG " %x %x",
+                     smp->pid, smp->cpl) - 1;
+      for(d=0 ; d<smp->depth ; d++)
+         len += snprintf(&line[len], sizeof(line)-len,
+                         " %lx", smp->pc[d]) - 1;
+
+      debug("%s\n", line);
+   }
+
+   __prof_top(first, prof_head);
+}
@@ -0,0 +1,196 @@
+/* GPLv2 (c) Airbus */
+#include <shm.h>
+#include <pmem.h>
+#include <debug.h>
+
+static shm_t shm_objs[SHM_NR_OBJ];
+
+static void __shm_release(shm_t *shm)
+{
+   size_t i;
+
+   for(i=0 ; i<shm->nr_pages ; i++)
+      pmem_put(shm->frames[i]);
+
+   shm->nr_pages = 0;
+}
+
+static int __shm_alloc(shm_t *shm, size_t nr, uint32_t flags)
+{
+   offset_t pa;
+   size_t   i;
+
+   if(flags & SHM_CONTIG)
+   {
+      pa = pmem_alloc_contig(nr);
+      if(!pa)
+         return -1;
+
+      for(i=0 ; i<nr ; i++)
+      {
+         shm->frames[i] = pa + i*PAGE_SIZE;
+         page_clear(__va(shm->frames[i]));
+      }
+
+      shm->nr_pages = nr;
+      return 0;
+   }
+
+   for(i=0 ; i<nr ; i++)
+   {
+      shm->frames[i] = pmem_alloc_zero();
+      if(!shm->frames[i])
+      {
+         shm->nr_pages = i;
+         __shm_release(shm);
+         return -1;
+      }
+   }
+
+   shm->nr_pages = nr;
+   return 0;
+}
+
+/*
+** Return the object registered under key, create
+** it with len bytes of zeroed memory if needed
+*/
+int shm_create(uint32_t key, size_t len, uint32_t flags)
+{
+   size_t nr = (len + PAGE_SIZE - 1)/PAGE_SIZE;
+   int    i, slot = -1;
+
+   for(i=0 ; i<SHM_NR_OBJ ; i++)
+   {
+      if(!shm_objs[i].nr_pages)
+      {
+         if(slot < 0)
+            slot = i;
+      }
+      else if(shm_objs[i].key == key)
+         return (nr <= shm_objs[i].nr_pages) ? i : -1;
+   }
+
+   if(slot < 0 || !nr || nr > SHM_MAX_PAGES)
+      return -1;
+
+   if(__shm_alloc(&shm_objs[slot], nr, flags) < 0)
+      return -1;
+
+   shm_objs[slot].key   = key;
+   shm_objs[slot].flags = flags;
+   shm_objs[slot].refs  = 0;
+   return slot;
+}
+
+/*
+** Map the whole object at va, or at a kernel chosen
+** address if va is null. Return the mapping address.
+*/
+offset_t shm_map(vm_t *vm, int id, offset_t va)
+{
+   shm_t  *shm;
+   size_t len, i;
+
+   if(id < 0 || id >= SHM_NR_OBJ || !shm_objs[id].nr_pages)
+      return 0;
+
+   shm = &shm_objs[id];
+   len = shm->nr_pages*PAGE_SIZE;
+
+   if(!va)
+      va = vm_find_free(vm, SHM_VA_START, SHM_VA_END, len);
+   else if(!vm_range_free(vm, va, len))
+      return 0;
+
+   if(!va)
+      return 0;
+
+   for(i=0 ; i<shm->nr_pages ; i++)
+   {
+      if(vm_map(vm, va + i*PAGE_SIZE, shm->frames[i], PG_USR|PG_RW|VM_PG_SHR) < 0)
+      {
+         while(i--)
+            pmem_put(vm_unmap(vm, va + i*PAGE_SIZE));
+
+         return 0;
+      }
+
+      pmem_get(shm->frames[i]);
+   }
+
+   shm->refs++;
+   return va;
+}
+
+/*
+** Unmap the object mapped at va: every page of
+** the range must map the matching object frame
+*/
+int shm_unmap(vm_t *vm, offset_t va)
+{
+   pte32_t *pte = vm_get_pte(vm, va);
+   shm_t   *shm = (shm_t*)0;
+   size_t  i;
+
+   if(!page_is_aligned(va) || va >= VM_USER_END || !pte || !pg_present(pte))
+      return -1;
+
+   for(i=0 ; i<SHM_NR_OBJ ; i++)
+      if(shm_objs[i].nr_pages &&
+         shm_objs[i].frames[0] == page_get_addr(pte->addr))
+      {
+         shm = &shm_objs[i];
+         break;
+      }
+
+   if(!shm || !shm->refs || va + shm->nr_pages*PAGE_SIZE > VM_USER_END)
+      return -1;
+
+   for(i=0 ; i<shm->nr_pages ; i++)
+   {
+      pte = vm_get_pte(vm, va + i*PAGE_SIZE);
+
+      if(!pte || !pg_present(pte) || !(pte->raw & VM_PG_SHR) ||
+         page_get_addr(pte->addr) != shm->frames[i])
+         return -1;
+   }
+
+   for(i=0 ; i<shm->nr_pages ; i++)
+      pmem_put(vm_unmap(vm, va + i*PAGE_SIZE));
+
+   if(!--shm->refs)
+      __shm_release(shm);
+
+   return 0;
+}
+
+/*
+** Release an object that is not mapped anywhere,
+** a mapped one goes away with its last mapping
+*/
+int shm_destroy(int id)
+{
+   if(id < 0 || id >= SHM_NR_OBJ || !shm_objs[id].nr_pages || shm_objs[id].refs)
+      return -1;
+
+   __shm_release(&shm_objs[id]);
+   return 0;
+}
+
+/*
+** vm_clone() duplicated a mapping: pa is the frame
+** found in the page, the object counts one mapping
+** per first page mapped
+*/
+void shm_dup(offset_t pa)
+{
+   size_t i;
+
+   for(i=0 ; i<SHM_NR_OBJ ; i++)
+      if(shm_objs[i].nr_pages && shm_objs[i].frames[0] == pa)
+      {
+         shm_objs[i].refs++;
+         return;
+      }
+}
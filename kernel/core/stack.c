@@ -1,21 +1,80 @@
 /* GPLv2 (c) Airbus */
 #include <debug.h>
 #include <info.h>
+#include <pagemem.h>
+#include <uaccess.h>
+#include <ksym.h>
 
 extern info_t   *info;
-extern offset_t __kernel_start__;
+extern char     __kernel_end__[];
 
+/*
+** Return addresses are looked up one byte back:
+** a call ending a function returns past its end
+*/
 void stack_trace(offset_t from)
 {
-   offset_t *ebp, *eip;
+   offset_t pcs[STACK_TRACE_MAX];
+   offset_t off;
+   char     name[KSYM_NAME_MAX];
+   size_t   i, n;
 
    printf("\n-= Stack Trace =-\n");
 
-   ebp = (offset_t*)from;
-   while(ebp && ebp < &__kernel_start__)
+   n = stack_walk(from, pcs, STACK_TRACE_MAX);
+   for(i=0 ; i<n ; i++)
    {
-      eip = (offset_t*)(*(ebp+1));
-      ebp = (offset_t*)(*ebp);
-      printf("%p\n", (void*)eip);
+      if(ksym_lookup(pcs[i] - 1, name, sizeof(name), &off))
+         printf("%p\n", (void*)pcs[i]);
+      else
+         printf("%p %s+0x%lx\n", (void*)pcs[i], name, off + 1);
    }
 }
+
+/*
+** User words are only read from present pages:
+** a walk never faults a page in
+*/
+static int __stack_word(offset_t va, uint32_t *w)
+{
+   pte32_t *pte;
+
+   if(va >= KERNEL_VMA)
+   {
+      if(va + sizeof(uint32_t) > (offset_t)__kernel_end__)
+         return -1;
+
+      *w = *(uint32_t*)va;
+      return 0;
+   }
+
+   if(!vm_current || !(pte = vm_get_pte(vm_current, va)) || !pg_present(pte))
+      return -1;
+
+   return get_user(w, (uint32_t*)va);
+}
+
+/*
+** Frame pointer walk from "ebp", at most "max" return
+** addresses. Callers frames sit higher on the stack:
+** the walk stops at the first one that does not
+*/
+size_t stack_walk(offset_t ebp, offset_t *pcs, size_t max)
+{
+   uint32_t next, ret;
+   size_t   n = 0;
+
+   while(n < max && ebp && !(ebp & 3))
+   {
+      if(__stack_word(ebp, &next) || __stack_word(ebp + 4, &ret) || !ret)
+         break;
+
+      pcs[n++] = ret;
+      if(next <= ebp)
+         break;
+
+      ebp = next;
+   }
+
+   return n;
+}
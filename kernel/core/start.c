@@ -3,8 +3,13 @@
 #include <debug.h>
 #include <pic.h>
 #include <uart.h>
+#include <console.h>
 #include <intr.h>
 #include <info.h>
+#include <pagemem.h>
+#include <string.h>
+#include <cpu.h>
+#include <fpu.h>
 
 volatile const uint32_t __mbh__ mbh[] = {
    MBH_MAGIC,
@@ -17,12 +22,18 @@ static info_t __info __attribute__ ((aligned(16)));
 
 void __attribute__((regparm(1))) start(mbi_t *mbi)
 {
-   info->mbi = mbi;
+   info->mbi = (mbi_t*)__va(mbi);
 
+   cpu_init();
+   string_init();
+   fpu_init();
+   page_init();
    pic_init();
    uart_init();
+   console_init(info->mbi);
    intr_init();
    debug("\n" RELEASE " (c) Airbus\n");
+   cpu_print();
 
    tp();
 
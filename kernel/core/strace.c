@@ -0,0 +1,105 @@
+/* GPLv2 (c) Airbus */
+#include <strace.h>
+#include <string.h>
+#include <debug.h>
+#include <asm.h>
+
+volatile uint32_t      strace_enabled;
+
+static strace_rec_t    strace_ring[STRACE_RING_LEN];
+static uint32_t        strace_head;           /* next slot, never wraps back */
+static strace_hist_t   strace_hist[STRACE_NR_SYS];
+
+static uint32_t __strace_bucket(uint32_t cycles)
+{
+   uint32_t b;
+
+   if(cycles < (1UL<<STRACE_HIST_SHIFT))
+      return 0;
+
+   b = 31 - __builtin_clz(cycles) - STRACE_HIST_SHIFT;
+   return b < STRACE_NR_BUCKETS ? b : STRACE_NR_BUCKETS - 1;
+}
+
+void strace_enable(uint32_t on)
+{
+   strace_enabled = on;
+}
+
+void strace_reset()
+{
+   memset((void*)strace_ring, 0, sizeof(strace_ring));
+   memset((void*)strace_hist, 0, sizeof(strace_hist));
+   strace_head = 0;
+}
+
+void strace_record(uint32_t pid, uint32_t nr, uint32_t *args, uint32_t ret,
+                   uint64_t start, uint64_t end)
+{
+   strace_rec_t  *rec = &strace_ring[strace_head++ & (STRACE_RING_LEN-1)];
+   uint32_t       cycles = (uint32_t)(end - start);
+   uint32_t       i;
+
+   rec->pid    = pid;
+   rec->nr     = nr;
+   rec->ret    = ret;
+   rec->cycles = cycles;
+   rec->tsc    = start;
+   for(i=0 ; i<5 ; i++)
+      rec->args[i] = args[i];
+
+   if(nr < STRACE_NR_SYS)
+   {
+      strace_hist_t *h = &strace_hist[nr];
+
+      if(!h->count || cycles < h->min)
+         h->min = cycles;
+      if(cycles > h->max)
+         h->max = cycles;
+
+      h->count++;
+      h->total += cycles;
+      h->buckets[__strace_bucket(cycles)]++;
+   }
+}
+
+/*
+** Oldest records first, then one histogram per used number
+*/
+void strace_dump()
+{
+   uint32_t  i, b, n, first;
+
+   n     = strace_head < STRACE_RING_LEN ? strace_head : STRACE_RING_LEN;
+   first = strace_head - n;
+
+   debug("strace: %u calls, last %u:\n", strace_head, n);
+   for(i=first ; i<strace_head ; i++)
+   {
+      strace_rec_t *rec = &strace_ring[i & (STRACE_RING_LEN-1)];
+
+      debug("  [%llu] pid %u sys %u (0x%x, 0x%x, 0x%x, 0x%x, 0x%x) = 0x%x"
+            " %u cycles\n",
+            rec->tsc, rec->pid, rec->nr,
+            rec->args[0], rec->args[1], rec->args[2],
+            rec->args[3], rec->args[4], rec->ret, rec->cycles);
+   }
+
+   for(i=0 ; i<STRACE_NR_SYS ; i++)
+   {
+      strace_hist_t *h = &strace_hist[i];
+      uint64_t      avg = h->total;
+
+      if(!h->count)
+         continue;
+
+      div64(&avg, h->count);
+      debug("strace: sys %u: %u calls, avg %llu min %u max %u cycles\n",
+            i, h->count, avg, h->min, h->max);
+
+      for(b=0 ; b<STRACE_NR_BUCKETS ; b++)
+         if(h->buckets[b])
+            debug("  >= %u: %u\n",
+                  b ? 1U<<(b+STRACE_HIST_SHIFT) : 0, h->buckets[b]);
+   }
+}
@@ -0,0 +1,160 @@
+/* GPLv2 (c) Airbus */
+#include <string.h>
+#include <cpu.h>
+
+/*
+** Below STRING_REP_MIN a plain loop beats the rep setup cost,
+** from STRING_ERMS_MIN a single "rep movsb/stosb" wins when
+** the cpu has ERMS
+*/
+#define STRING_REP_MIN     8
+#define STRING_ERMS_MIN    64
+
+bool_t string_erms;
+
+void string_init()
+{
+   string_erms = cpu_has(CPU_ERMS) ? true : false;
+}
+
+/*
+** Byte moves up to a dword aligned destination,
+** dword moves, byte moves for the tail
+*/
+void* __memcpy(void *dst, const void *src, size_t size)
+{
+   loc_t  d, s;
+   size_t head;
+
+   d.addr = dst;
+   s.addr = (void*)src;
+
+   if(size < STRING_REP_MIN)
+   {
+      while(size--)
+         *d.u8++ = *s.u8++;
+      return dst;
+   }
+
+   if(string_erms && size >= STRING_ERMS_MIN)
+   {
+      __memcpy8(d.linear, s.linear, size, 0);
+      return dst;
+   }
+
+   head  = -d.linear & (sizeof(uint32_t)-1);
+   size -= head;
+
+   asm volatile ("rep movsb          \n"
+                 "mov  %k3, %%ecx    \n"
+                 "shr  $2, %%ecx     \n"
+                 "rep movsl          \n"
+                 "mov  %k3, %%ecx    \n"
+                 "and  $3, %%ecx     \n"
+                 "rep movsb          \n"
+                 :"+D"(d.linear),"+S"(s.linear),"+c"(head)
+                 :"r"(size)
+                 :"memory","cc");
+   return dst;
+}
+
+void* __memset(void *dst, uint8_t c, size_t size)
+{
+   loc_t    d;
+   size_t   head;
+   uint32_t v;
+
+   d.addr = dst;
+
+   if(size < STRING_REP_MIN)
+   {
+      while(size--)
+         *d.u8++ = c;
+      return dst;
+   }
+
+   if(string_erms && size >= STRING_ERMS_MIN)
+   {
+      __memset8(d.linear, c, size, 0);
+      return dst;
+   }
+
+   v     = __replicate_byte_on_dword(c);
+   head  = -d.linear & (sizeof(uint32_t)-1);
+   size -= head;
+
+   asm volatile ("rep stosb          \n"
+                 "mov  %k3, %%ecx    \n"
+                 "shr  $2, %%ecx     \n"
+                 "rep stosl          \n"
+                 "mov  %k3, %%ecx    \n"
+                 "and  $3, %%ecx     \n"
+                 "rep stosb          \n"
+                 :"+D"(d.linear),"+c"(head)
+                 :"a"(v),"r"(size)
+                 :"memory","cc");
+   return dst;
+}
+
+/*
+** Overlapping with dst above src: copy downwards,
+** tail bytes first then dwords
+*/
+void* memmove(void *dst, const void *src, size_t size)
+{
+   loc_t  d, s;
+   size_t tail;
+
+   d.addr = dst;
+   s.addr = (void*)src;
+
+   if(d.linear <= s.linear || d.linear >= s.linear + size)
+      return __memcpy(dst, src, size);
+
+   d.linear += size - 1;
+   s.linear += size - 1;
+   tail      = size & 3;
+
+   asm volatile ("std                \n"
+                 "rep movsb          \n"
+                 "sub  $3, %0        \n"
+                 "sub  $3, %1        \n"
+                 "mov  %k3, %%ecx    \n"
+                 "shr  $2, %%ecx     \n"
+                 "rep movsl          \n"
+                 "cld                \n"
+                 :"+D"(d.linear),"+S"(s.linear),"+c"(tail)
+                 :"r"(size)
+                 :"memory","cc");
+   return dst;
+}
+
+int memcmp(const void *s1, const void *s2, size_t size)
+{
+   const uint8_t *a = (const uint8_t*)s1;
+   const uint8_t *b = (const uint8_t*)s2;
+
+   /* skip equal dwords, then find the differing byte */
+   while(size >= sizeof(uint32_t) &&
+         *(const __str32_t*)a == *(const __str32_t*)b)
+   {
+      a    += sizeof(uint32_t);
+      b    += sizeof(uint32_t);
+      size -= sizeof(uint32_t);
+   }
+
+   for( ; size ; a++, b++, size--)
+      if(*a != *b)
+         return *a - *b;
+
+   return 0;
+}
+
+int strncmp(const char *s1, const char *s2, size_t size)
+{
+   for( ; size ; s1++, s2++, size--)
+      if(*s1 != *s2 || !*s1)
+         return (uint8_t)*s1 - (uint8_t)*s2;
+
+   return 0;
+}
@@ -0,0 +1,120 @@
+/* GPLv2 (c) Airbus */
+#include <uaccess.h>
+
+/*
+** rep movsl for the bulk then rep movsb for the tail,
+** on fault %ecx still holds the count left to move
+*/
+static size_t __copy_user(void *dst, const void *src, size_t len)
+{
+   size_t left;
+
+   asm volatile (
+      "cld                        \n"
+      "1: rep movsl               \n"
+      "   mov  %3, %%ecx          \n"
+      "2: rep movsb               \n"
+      "3:                         \n"
+      ".section .fixup,\"ax\"     \n"
+      "4: lea  (%3,%%ecx,4), %%ecx\n"
+      "   jmp  3b                 \n"
+      ".previous                  \n"
+      ".section __ex_table,\"a\"  \n"
+      "   .align 4                \n"
+      "   .long 1b, 4b            \n"
+      "   .long 2b, 3b            \n"
+      ".previous                  \n"
+      :"=&c"(left), "+D"(dst), "+S"(src)
+      :"r"(len & 3), "0"(len >> 2)
+      :"memory");
+
+   return left;
+}
+
+size_t copy_from_user(void *dst, const void *usrc, size_t len)
+{
+   if(!uaccess_ok(usrc, len))
+      return len;
+
+   return __copy_user(dst, usrc, len);
+}
+
+size_t copy_to_user(void *udst, const void *src, size_t len)
+{
+   if(!uaccess_ok(udst, len))
+      return len;
+
+   return __copy_user(udst, src, len);
+}
+
+int get_user(uint32_t *val, const uint32_t *uptr)
+{
+   uint32_t v;
+   int      err;
+
+   if(!uaccess_ok(uptr, sizeof(uint32_t)))
+      return -1;
+
+   asm volatile (
+      "1: movl (%2), %1           \n"
+      "2:                         \n"
+      ".section .fixup,\"ax\"     \n"
+      "3: movl $-1, %0            \n"
+      "   xorl %1, %1             \n"
+      "   jmp  2b                 \n"
+      ".previous                  \n"
+      ".section __ex_table,\"a\"  \n"
+      "   .align 4                \n"
+      "   .long 1b, 3b            \n"
+      ".previous                  \n"
+      :"=r"(err), "=r"(v)
+      :"r"(uptr), "0"(0));
+
+   *val = v;
+   return err;
+}
+
+int put_user(uint32_t val, uint32_t *uptr)
+{
+   int err;
+
+   if(!uaccess_ok(uptr, sizeof(uint32_t)))
+      return -1;
+
+   asm volatile (
+      "1: movl %1, (%2)           \n"
+      "2:                         \n"
+      ".section .fixup,\"ax\"     \n"
+      "3: movl $-1, %0            \n"
+      "   jmp  2b                 \n"
+      ".previous                  \n"
+      ".section __ex_table,\"a\"  \n"
+      "   .align 4                \n"
+      "   .long 1b, 3b            \n"
+      ".previous                  \n"
+      :"=r"(err)
+      :"r"(val), "r"(uptr), "0"(0)
+      :"memory");
+
+   return err;
+}
+
+/*
+** Called on kernel page faults the vm could not resolve
+*/
+bool_t uaccess_fixup(int_ctx_t *ctx)
+{
+   ex_entry_t *ex;
+
+   if(ctx->err.pf.us)
+      return false;
+
+   for(ex=__ex_table_start__ ; ex<__ex_table_end__ ; ex++)
+      if(ex->insn == ctx->eip.raw)
+      {
+         ctx->eip.raw = ex->fixup;
+         return true;
+      }
+
+   return false;
+}
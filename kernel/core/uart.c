@@ -1,5 +1,31 @@
 /* GPLv2 (c) Airbus */
 #include <uart.h>
+#include <intr.h>
+#include <pic.h>
+#include <asm.h>
+
+uart_tx_stats_t          uart_tx_stats;
+uart_rx_stats_t          uart_rx_stats;
+
+static uint8_t           uart_tx_ring[UART_TX_RING_LEN];
+static volatile uint32_t uart_tx_head;   /* producer */
+static volatile uint32_t uart_tx_tail;   /* consumer */
+static volatile uint32_t uart_tx_policy;
+static volatile bool_t   uart_tx_irq;
+
+/* bytes pushed per THR empty check: 1, or UART_FIFO_LEN once enabled */
+static uint32_t          uart_tx_burst = 1;
+
+#define __uart_tx_used()     (uart_tx_head - uart_tx_tail)
+#define __uart_tx_full()     (__uart_tx_used() == UART_TX_RING_LEN)
+
+static uint8_t           uart_rx_ring[UART_RX_RING_LEN];
+static volatile uint32_t uart_rx_head;   /* irq handler */
+static volatile uint32_t uart_rx_tail;   /* uart_read() */
+static volatile bool_t   uart_rx_irq;
+static void              (*uart_rx_wake)(void);   /* uart_rx_notify() */
+
+#define __uart_rx_used()     (uart_rx_head - uart_rx_tail)
 
 static void __uart_flush_recv(uint16_t port)
 {
@@ -7,9 +33,33 @@ static void __uart_flush_recv(uint16_t port)
       __uart_recv_char(port);
 }
 
-static void __uart_fifo_init(uint16_t port)
+/*
+** Enable (and clear) the fifos, the transmitter
+** is then fed UART_FIFO_LEN bytes per THR empty.
+** EFR shares its port with FCR: on a plain 16550
+** the EFR writes land in FCR, so FCR goes last.
+*/
+static void __uart_fifo_setup(uint16_t port, bool_t on)
 {
    serial_fcr_reg_t  fcr;
+   serial_iir_reg_t  iir;
+
+   fcr.raw = 0;
+   if(on)
+   {
+      fcr.enable = 1;
+      fcr.rx = 1;
+      fcr.tx = 1;
+      fcr.rx_trigger = UART_RX_TRIGGER;
+   }
+   out(fcr.raw, SERIAL_FCR(port));
+
+   iir.raw = in(SERIAL_IIR(port));
+   uart_tx_burst = (iir.fifo == SERIAL_IIR_INFO_FIFO_ENABLED) ? UART_FIFO_LEN : 1;
+}
+
+static void __uart_fifo_init(uint16_t port)
+{
    serial_efr_reg_t  efr;
 
    uart_enable_efr_registers(port);
@@ -17,16 +67,28 @@ static void __uart_fifo_init(uint16_t port)
    efr.ctl = 1;
    out(efr.raw, SERIAL_EFR(port));
 
-   fcr.enable = 0;
-   fcr.dma = 0;
-   out(fcr.raw, SERIAL_FCR(port));
-
-   out(0, SERIAL_LCR(port));
-
    efr.raw = 0;
    efr.a_rts = 1;
    efr.a_cts = 1;
    out(efr.raw, SERIAL_EFR(port));
+
+   out(0, SERIAL_LCR(port));
+
+   __uart_fifo_setup(port, true);
+}
+
+static void __uart_set_divisor(uint16_t port, uint16_t div)
+{
+   serial_lcr_reg_t  lcr;
+
+   lcr.raw = in(SERIAL_LCR(port));
+
+   uart_enable_dla_registers(port);
+   uart_set_lsb_dla_rate(port, div & 0xff);
+   uart_set_msb_dla_rate(port, div >> 8);
+
+   lcr.dla = 0;
+   out(lcr.raw, SERIAL_LCR(port));
 }
 
 static void __uart_common_init(uint16_t port)
@@ -35,10 +97,7 @@ static void __uart_common_init(uint16_t port)
    serial_lcr_reg_t  lcr;
    /* serial_mcr_reg_t  mcr; */
 
-   /* set baud rate to 115200 */
-   uart_enable_dla_registers(port);
-   uart_set_lsb_dla_rate(port, 0x01);
-   uart_set_msb_dla_rate(port, 0x00);
+   __uart_set_divisor(port, UART_CLOCK/UART_BAUD);
 
    /* 8 bits, 1 stop bit, no parity */
    lcr.raw = 0;
@@ -79,12 +138,17 @@ static inline void __uart_read(uint16_t port, buffer_t *buf, size_t max)
 
 static inline void __uart_write(uint16_t port, buffer_t *buf, size_t max)
 {
+   uint32_t n;
+
    while(buf->sz < max)
    {
       if(__uart_can_send(port))
       {
-         __uart_send_char(port, buf->data.u8[buf->sz]);
-         buf->sz++;
+         for(n=uart_tx_burst ; n && buf->sz < max ; n--)
+         {
+            __uart_send_char(port, buf->data.u8[buf->sz]);
+            buf->sz++;
+         }
       }
    }
 }
@@ -92,18 +156,197 @@ static inline void __uart_write(uint16_t port, buffer_t *buf, size_t max)
 size_t uart_read(uint8_t *data, size_t n)
 {
    buffer_t buf;
+   ulong_t  flags;
 
    buf.data.u8 = data;
    buf.sz = 0;
 
-   __uart_read(SERIAL_COM1, &buf, n);
+   if(!uart_rx_irq)
+   {
+      __uart_read(SERIAL_COM1, &buf, n);
+      return buf.sz;
+   }
+
+   disable_interrupts(flags);
+   while(buf.sz < n && __uart_rx_used())
+      buf.data.u8[buf.sz++] = uart_rx_ring[uart_rx_tail++ & (UART_RX_RING_LEN-1)];
+   restore_interrupts(flags);
+
    return buf.sz;
 }
 
+/*
+** Move queued bytes to the THR while it is empty,
+** called with interrupts disabled
+*/
+static void __uart_tx_pump(uint16_t port)
+{
+   uint32_t n;
+
+   while(__uart_tx_used() && __uart_can_send(port))
+      for(n=uart_tx_burst ; n && __uart_tx_used() ; n--)
+         __uart_send_char(port, uart_tx_ring[uart_tx_tail++ & (UART_TX_RING_LEN-1)]);
+}
+
+/*
+** Empty the ring and the transmitter before
+** touching the line settings
+*/
+static void __uart_tx_drain()
+{
+   ulong_t flags;
+
+   disable_interrupts(flags);
+   while(__uart_tx_used())
+      __uart_tx_pump(SERIAL_COM1);
+   while(!(in(SERIAL_LSR(SERIAL_COM1)) & SERIAL_LSR_TSRE));
+   restore_interrupts(flags);
+}
+
+/*
+** Empty the rx fifo into the ring, accounting
+** line errors reported along with each byte
+*/
+static void __uart_rx_pump(uint16_t port)
+{
+   serial_lsr_reg_t lsr;
+   uint8_t          c;
+
+   while(1)
+   {
+      lsr.raw = in(SERIAL_LSR(port));
+
+      if(lsr.overrun)
+         uart_rx_stats.hw_overruns++;
+      if(lsr.parity || lsr.fram || lsr.brk)
+         uart_rx_stats.errors++;
+      if(!lsr.data)
+         break;
+
+      c = __uart_recv_char(port);
+      if(__uart_rx_used() == UART_RX_RING_LEN)
+      {
+         uart_rx_stats.overruns++;
+         continue;
+      }
+
+      uart_rx_ring[uart_rx_head++ & (UART_RX_RING_LEN-1)] = c;
+      uart_rx_stats.received++;
+   }
+}
+
+/*
+** Reading IIR acknowledges the THR empty interrupt,
+** the rx sources are cleared by emptying the fifo
+*/
+#define UART_IRQ_LOOPS          16
+
+static void __uart_irq_hdlr(int_ctx_t __unused__ *ctx)
+{
+   serial_iir_reg_t iir;
+   uint32_t         n, head = uart_rx_head;
+
+   uart_tx_stats.irqs++;
+
+   for(n=0 ; n<UART_IRQ_LOOPS ; n++)
+   {
+      iir.raw = in(SERIAL_IIR(SERIAL_COM1));
+      if(iir.no_int_pending)
+         break;
+
+      switch(iir.info)
+      {
+      case SERIAL_IIR_INFO_RECV_DATA_AVAILABLE:
+      case SERIAL_IIR_INFO_CHAR_TIMEOUT:
+      case SERIAL_IIR_INFO_LINE_STATUS_CHANGE:
+         __uart_rx_pump(SERIAL_COM1);
+         break;
+      case SERIAL_IIR_INFO_MODEM_STATUS_CHANGE:
+         in(SERIAL_MSR(SERIAL_COM1));
+         break;
+      }
+   }
+
+   __uart_tx_pump(SERIAL_COM1);
+
+   if(uart_rx_wake && uart_rx_head != head)
+      uart_rx_wake();
+}
+
+/*
+** Route IRQ4 to the handler and unmask the given sources
+*/
+static void __uart_irq_enable(uint8_t sources)
+{
+   serial_ier_reg_t  ier;
+   serial_mcr_reg_t  mcr;
+
+   intr_irq_register(PIC_UART1_IRQ, __uart_irq_hdlr);
+
+   /* OUT2 gates the uart irq line on PC boards */
+   mcr.raw  = in(SERIAL_MCR(SERIAL_COM1));
+   mcr.aux2 = 1;
+   out(mcr.raw, SERIAL_MCR(SERIAL_COM1));
+
+   ier.raw  = in(SERIAL_IER(SERIAL_COM1));
+   ier.raw |= sources;
+   out(ier.raw, SERIAL_IER(SERIAL_COM1));
+}
+
+static size_t __uart_tx_queue(uint16_t port, uint8_t *data, size_t n)
+{
+   ulong_t  flags;
+   uint32_t tail;
+   size_t   done = 0;
+
+   while(1)
+   {
+      disable_interrupts(flags);
+      while(done < n && !__uart_tx_full())
+         uart_tx_ring[uart_tx_head++ & (UART_TX_RING_LEN-1)] = data[done++];
+      __uart_tx_pump(port);
+      restore_interrupts(flags);
+
+      if(done == n)
+         break;
+
+      if(uart_tx_policy == UART_TX_DROP)
+      {
+         uart_tx_stats.dropped += n - done;
+         break;
+      }
+
+      /*
+      ** UART_TX_BLOCK: the irq handler makes room, unless
+      ** we are running with interrupts disabled (irq handler,
+      ** critical section) and must fall back to polling
+      */
+      if(uart_tx_policy == UART_TX_BLOCK && (flags & EFLAGS_IF))
+      {
+         while(__uart_tx_full())
+            asm volatile ("pause");
+         continue;
+      }
+
+      disable_interrupts(flags);
+      while(!__uart_can_send(port));
+      tail = uart_tx_tail;
+      __uart_tx_pump(port);
+      uart_tx_stats.polled += uart_tx_tail - tail;
+      restore_interrupts(flags);
+   }
+
+   uart_tx_stats.queued += done;
+   return done;
+}
+
 size_t uart_write(uint8_t *data, size_t n)
 {
    buffer_t buf;
 
+   if(uart_tx_irq)
+      return __uart_tx_queue(SERIAL_COM1, data, n);
+
    buf.data.u8 = data;
    buf.sz = 0;
 
@@ -111,6 +354,91 @@ size_t uart_write(uint8_t *data, size_t n)
    return buf.sz;
 }
 
+/*
+** Switch to interrupt driven transmit
+*/
+void uart_tx_async(uint32_t policy)
+{
+   uart_tx_policy = policy;
+   __uart_irq_enable(SERIAL_IER_THRE);
+   uart_tx_irq = true;
+}
+
+/*
+** Switch to interrupt driven receive
+*/
+void uart_rx_async()
+{
+   ulong_t flags;
+
+   disable_interrupts(flags);
+   uart_rx_irq = true;
+   __uart_irq_enable(SERIAL_IER_RECV|SERIAL_IER_RLSR);
+   __uart_rx_pump(SERIAL_COM1);
+   restore_interrupts(flags);
+}
+
+/*
+** fn is called from the irq handler each time
+** bytes were queued in the rx ring
+*/
+void uart_rx_notify(void (*fn)(void))
+{
+   uart_rx_wake = fn;
+}
+
+/*
+** Back to synchronous transmit, flushing the ring first:
+** safe with interrupts disabled (panic)
+*/
+void uart_sync()
+{
+   serial_ier_reg_t  ier;
+   ulong_t           flags;
+
+   disable_interrupts(flags);
+   uart_tx_irq = false;
+
+   ier.raw  = in(SERIAL_IER(SERIAL_COM1));
+   ier.thre = 0;
+   out(ier.raw, SERIAL_IER(SERIAL_COM1));
+
+   restore_interrupts(flags);
+   __uart_tx_drain();
+}
+
+/*
+** Only exact divisors of UART_CLOCK are accepted
+*/
+int uart_set_baud(uint32_t baud)
+{
+   uint32_t div;
+   ulong_t  flags;
+
+   if(!baud || baud > UART_CLOCK || UART_CLOCK % baud)
+      return -1;
+
+   div = UART_CLOCK/baud;
+   if(div > 0xffff)
+      return -1;
+
+   disable_interrupts(flags);
+   __uart_tx_drain();
+   __uart_set_divisor(SERIAL_COM1, div);
+   restore_interrupts(flags);
+   return 0;
+}
+
+void uart_set_fifo(bool_t on)
+{
+   ulong_t flags;
+
+   disable_interrupts(flags);
+   __uart_tx_drain();
+   __uart_fifo_setup(SERIAL_COM1, on);
+   restore_interrupts(flags);
+}
+
 void uart_flush()
 {
    size_t s = 16;
@@ -0,0 +1,65 @@
+/* GPLv2 (c) Airbus */
+#include <uring.h>
+#include <pmem.h>
+
+/*
+** Map a zeroed ring page at *va (kernel chosen if null),
+** return its kernel address
+*/
+uring_t* uring_create(vm_t *vm, offset_t *va)
+{
+   offset_t pa;
+
+   if(!*va)
+      *va = vm_find_free(vm, URING_VA_START, URING_VA_END, PAGE_SIZE);
+   else if(!vm_range_free(vm, *va, PAGE_SIZE))
+      return (uring_t*)0;
+
+   if(!*va)
+      return (uring_t*)0;
+
+   pa = pmem_alloc_zero();
+   if(!pa)
+      return (uring_t*)0;
+
+   if(vm_map(vm, *va, pa, PG_USR|PG_RW|VM_PG_SHR) < 0)
+   {
+      pmem_put(pa);
+      return (uring_t*)0;
+   }
+
+   return (uring_t*)__va(pa);
+}
+
+/*
+** Execute pending submissions while completions fit.
+** Entries are copied first: the task may rewrite the
+** ring while we run.
+*/
+size_t uring_drain(uring_t *ring, uring_exec_t exec)
+{
+   uint32_t head = ring->sq_head;
+   uint32_t tail = ring->sq_tail;
+   size_t   done = 0;
+
+   /* bogus task indexes */
+   if(tail - head > URING_ENTRIES)
+      tail = head + URING_ENTRIES;
+
+   while(head != tail && ring->cq_tail - ring->cq_head < URING_ENTRIES)
+   {
+      uring_sqe_t  sqe = ring->sq[head % URING_ENTRIES];
+      uring_cqe_t *cqe = &ring->cq[ring->cq_tail % URING_ENTRIES];
+
+      cqe->user_data = sqe.user_data;
+      cqe->res       = exec(&sqe);
+      barrier();
+      ring->cq_tail++;
+
+      head++;
+      done++;
+   }
+
+   ring->sq_head = head;
+   return done;
+}
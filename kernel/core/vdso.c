@@ -0,0 +1,167 @@
+/* GPLv2 (c) Airbus */
+#include <vdso.h>
+#include <pmem.h>
+#include <io.h>
+#include <asm.h>
+#include <debug.h>
+#include <cpu.h>
+
+vdso_t          *vdso;
+static offset_t  vdso_pa;
+static uint64_t  vdso_tsc_start;         /* first switch */
+
+/*
+** PIT channel 2 one-shot (gate through port 0x61)
+*/
+#define PIT_FREQ                1193182UL
+#define PIT_CH2                 0x42
+#define PIT_CMD                 0x43
+#define PIT_GATE                0x61
+
+#define PIT_CALIBRATE_MS        10
+
+/*
+** IRQ0 period with the BIOS divisor (65536)
+*/
+#define PIT_TICK_NS             54925439ULL
+
+static uint32_t __vdso_tsc_khz()
+{
+   uint32_t latch = PIT_FREQ*PIT_CALIBRATE_MS/1000;
+   uint64_t t0, t1;
+
+   outb((inb(PIT_GATE) & ~0x02) | 0x01, PIT_GATE);
+   outb(0xb0, PIT_CMD);                  /* ch2, lo/hi, mode 0 */
+   outb(latch & 0xff, PIT_CH2);
+   outb(latch >> 8, PIT_CH2);
+
+   t0 = rdtsc();
+   while(!(inb(PIT_GATE) & 0x20));       /* OUT2 at terminal count */
+   t1 = rdtsc();
+
+   t1 -= t0;
+   div64(&t1, PIT_CALIBRATE_MS);
+   return (uint32_t)t1;
+}
+
+#define __vdso_write_begin()    ({ vdso->seq++; barrier(); })
+#define __vdso_write_end()      ({ barrier(); vdso->seq++; })
+
+/*
+** Fold elapsed cycles into the monotonic clock
+*/
+static void __vdso_update_clock(uint64_t now)
+{
+   uint64_t delta = now - vdso->tsc_base;
+
+   vdso->ns_base  += (delta * vdso->mult) >> VDSO_SHIFT;
+   vdso->tsc_base  = now;
+}
+
+void vdso_init()
+{
+   vdso_pa = pmem_alloc_zero();
+   if(!vdso_pa)
+      panic("vdso: out of memory\n");
+
+   vdso = (vdso_t*)__va(vdso_pa);
+   vdso->features = info->cpu.features;
+
+   /* clock source: the TSC, or the timer ticks without it */
+   if(!cpu_has(CPU_TSC))
+   {
+      debug("vdso: no tsc, clock from timer ticks\n");
+      return;
+   }
+
+   vdso->tsc_khz  = __vdso_tsc_khz();
+   if(vdso->tsc_khz)
+   {
+      uint64_t mult = 1000000ULL << VDSO_SHIFT;
+
+      div64(&mult, vdso->tsc_khz);
+      vdso->mult  = (uint32_t)mult;
+   }
+
+   vdso->tsc_base = rdtsc();
+   debug("vdso: tsc %u kHz%s\n", vdso->tsc_khz,
+         cpu_has(CPU_INVTSC) ? " (invariant)" : "");
+}
+
+int vdso_map(vm_t *vm)
+{
+   if(!vdso)
+      return -1;
+
+   pmem_get(vdso_pa);
+   return vm_map(vm, VDSO_VA, vdso_pa, PG_USR|PG_RO|VM_PG_SHR);
+}
+
+void vdso_tick()
+{
+   __vdso_write_begin();
+   if(vdso->mult)
+      __vdso_update_clock(rdtsc());
+   else
+      vdso->ns_base += PIT_TICK_NS;
+   vdso->ticks++;
+   __vdso_write_end();
+}
+
+/*
+** Account the running task and publish the next one. The
+** task is charged from its own switch in: vdso_tick() moves
+** tsc_base just before
+*/
+void vdso_switch(uint32_t pid)
+{
+   uint64_t now = cpu_rdtsc();
+
+   if(pid >= VDSO_NR_TASKS)
+      return;
+
+   __vdso_write_begin();
+
+   if(!vdso->nr_tasks)
+      vdso_tsc_start = now;
+   else if(vdso->pid < VDSO_NR_TASKS)
+      vdso->tasks[vdso->pid].tsc += now - vdso->tasks[vdso->pid].tsc_in;
+
+   __vdso_update_clock(now);
+
+   vdso->pid = pid;
+   vdso->tasks[pid].pid = pid;
+   vdso->tasks[pid].tsc_in = now;
+   vdso->tasks[pid].switches++;
+   if(pid >= vdso->nr_tasks)
+      vdso->nr_tasks = pid + 1;
+
+   __vdso_write_end();
+}
+
+/*
+** Tasks share the cpu: their cycles add up to the
+** time elapsed since the first switch, minus the
+** running slice
+*/
+void vdso_stats()
+{
+   uint64_t total = 0, elapsed;
+   uint32_t i;
+
+   if(!vdso || !vdso->nr_tasks || !cpu_has(CPU_TSC))
+      return;
+
+   debug("\n-= Tasks =-\n");
+   for(i=0 ; i<vdso->nr_tasks ; i++)
+   {
+      vdso_task_t *t = &vdso->tasks[i];
+
+      debug("pid %u: %u switches, %llu cycles\n", t->pid, t->switches, t->tsc);
+      total += t->tsc;
+   }
+
+   elapsed = vdso->tasks[vdso->pid].tsc_in - vdso_tsc_start;
+   debug("%llu cycles accounted for %llu elapsed%s\n", total, elapsed,
+         total == elapsed ? "" : " (lost cycles)");
+}
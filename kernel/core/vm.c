@@ -0,0 +1,418 @@
+/* GPLv2 (c) Airbus */
+#include <vm.h>
+#include <pmem.h>
+#include <cr.h>
+#include <asm.h>
+#include <cpu.h>
+#include <debug.h>
+
+vm_t          *vm_current;
+vm_flt_stat_t  vm_flt_stats[VM_FLT_NR];
+
+static char* vm_flt_names[] = {
+   "demand-zero",
+   "cow copy",
+   "cow reuse",
+   "unresolved",
+};
+
+void vm_init(vm_t *vm)
+{
+   pde32_t  *kpgd = (pde32_t*)__boot_pgd__;
+   offset_t pa;
+   size_t   i;
+
+   pa = pmem_alloc_zero();
+   if(!pa)
+      panic("vm_init: out of memory\n");
+
+   vm->pgd    = (pde32_t*)__va(pa);
+   vm->nr_rgn = 0;
+
+   /* kernel PDEs are 4MB pages set at boot, sharing is a copy */
+   for(i=pd32_get_idx(KERNEL_VMA) ; i<PDE32_PER_PD ; i++)
+      vm->pgd[i].raw = kpgd[i].raw;
+}
+
+/*
+** Weak: shm.o is only linked in the kernels using it
+*/
+extern void shm_dup(offset_t) __attribute__((weak));
+
+/*
+** Give back the page tables and the pgd of a clone
+** that failed before any frame was shared
+*/
+static void __vm_clone_undo(vm_t *dst)
+{
+   size_t i;
+
+   for(i=0 ; i<pd32_get_idx(VM_USER_END) ; i++)
+      if(pg_present(&dst->pgd[i]))
+         pmem_put(page_get_addr(dst->pgd[i].addr));
+
+   pmem_put(__pa(dst->pgd));
+   dst->pgd = (pde32_t*)0;
+}
+
+/*
+** Share every user frame of src with dst: writable private
+** pages become read-only copy-on-write in both spaces, only
+** page tables are duplicated.
+**
+** All page tables are allocated first: src is only touched
+** once nothing can fail.
+*/
+int vm_clone(vm_t *dst, vm_t *src)
+{
+   size_t i, j;
+
+   vm_init(dst);
+
+   for(i=0 ; i<pd32_get_idx(VM_USER_END) ; i++)
+   {
+      offset_t ptb;
+
+      if(!pg_present(&src->pgd[i]))
+         continue;
+
+      ptb = pmem_alloc();
+      if(!ptb)
+      {
+         __vm_clone_undo(dst);
+         return -1;
+      }
+
+      dst->pgd[i].raw  = src->pgd[i].raw;
+      dst->pgd[i].addr = page_get_nr(ptb);
+   }
+
+   for(i=0 ; i<src->nr_rgn ; i++)
+      dst->rgn[i] = src->rgn[i];
+
+   dst->nr_rgn = src->nr_rgn;
+
+   for(i=0 ; i<pd32_get_idx(VM_USER_END) ; i++)
+   {
+      pte32_t  *sptb, *dptb;
+
+      if(!pg_present(&src->pgd[i]))
+         continue;
+
+      sptb = (pte32_t*)__va(page_get_addr(src->pgd[i].addr));
+      dptb = (pte32_t*)__va(page_get_addr(dst->pgd[i].addr));
+
+      for(j=0 ; j<PTE32_PER_PT ; j++)
+      {
+         pte32_t *pte = &sptb[j];
+
+         if(pg_present(pte))
+         {
+            if(pte->raw & VM_PG_SHR)
+            {
+               if(shm_dup)
+                  shm_dup(page_get_addr(pte->addr));
+            }
+            else if(pte->rw)
+            {
+               pte->rw   = 0;
+               pte->raw |= VM_PG_COW;
+            }
+
+            pmem_get(page_get_addr(pte->addr));
+         }
+
+         dptb[j].raw = pte->raw;
+      }
+   }
+
+   /* write permissions removed */
+   if(src == vm_current)
+      set_cr3(get_cr3());
+
+   return 0;
+}
+
+pte32_t* vm_get_pte(vm_t *vm, offset_t va)
+{
+   pde32_t *pde = &vm->pgd[pd32_get_idx(va)];
+   pte32_t *ptb;
+
+   if(!pg_present(pde))
+      return (pte32_t*)0;
+
+   ptb = (pte32_t*)__va(page_get_addr(pde->addr));
+   return &ptb[pt32_get_idx(va)];
+}
+
+int vm_map(vm_t *vm, offset_t va, offset_t pa, uint32_t attr)
+{
+   pde32_t *pde = &vm->pgd[pd32_get_idx(va)];
+   pte32_t *pte;
+   bool_t  flush;
+
+   if(!pg_present(pde))
+   {
+      offset_t ptb = pmem_alloc_zero();
+
+      if(!ptb)
+         return -1;
+
+      pg_set_entry(pde, PG_USR|PG_RW, page_get_nr(ptb));
+   }
+
+   pte = vm_get_pte(vm, va);
+
+   /* non present entries are never cached */
+   flush = (pg_present(pte) && vm == vm_current) ? true : false;
+
+   pg_set_entry(pte, attr, page_get_nr(pa));
+
+   if(flush)
+      invalidate(va);
+
+   return 0;
+}
+
+/*
+** Batched TLB shootdown after nr pages changed at va
+*/
+void vm_flush(vm_t *vm, offset_t va, size_t nr)
+{
+   if(vm != vm_current)
+      return;
+
+   if(nr > VM_FLUSH_MAX)
+   {
+      set_cr3(get_cr3());
+      return;
+   }
+
+   while(nr--)
+   {
+      invalidate(va);
+      va += PAGE_SIZE;
+   }
+}
+
+/*
+** Remove a page mapping, return the frame it referenced
+** (the caller owns the reference) or 0
+*/
+offset_t vm_unmap(vm_t *vm, offset_t va)
+{
+   pte32_t  *pte = vm_get_pte(vm, va);
+   offset_t pa;
+
+   if(!pte || !pg_present(pte))
+      return 0;
+
+   pa = page_get_addr(pte->addr);
+   pg_set_zero(pte);
+
+   if(vm == vm_current)
+      invalidate(va);
+
+   return pa;
+}
+
+/*
+** No page mapped nor region reserved in [va - va+len[
+*/
+bool_t vm_range_free(vm_t *vm, offset_t va, size_t len)
+{
+   offset_t end = va + len;
+   size_t   i;
+
+   if(!page_is_aligned(va) || end <= va || end > VM_USER_END)
+      return false;
+
+   for(i=0 ; i<vm->nr_rgn ; i++)
+      if(va < vm->rgn[i].end && vm->rgn[i].start < end)
+         return false;
+
+   for( ; va<end ; va+=PAGE_SIZE)
+   {
+      pte32_t *pte = vm_get_pte(vm, va);
+
+      if(pte && pg_present(pte))
+         return false;
+   }
+
+   return true;
+}
+
+/*
+** First fit for len bytes inside [start - end[
+*/
+offset_t vm_find_free(vm_t *vm, offset_t start, offset_t end, size_t len)
+{
+   offset_t va;
+
+   len = page_align(len + PAGE_SIZE - 1);
+
+   for(va=page_align(start) ; va+len <= end ; va+=PAGE_SIZE)
+      if(vm_range_free(vm, va, len))
+         return va;
+
+   return 0;
+}
+
+int vm_reserve(vm_t *vm, offset_t start, size_t len, uint32_t flags)
+{
+   offset_t end = start + len;
+   size_t   i;
+
+   if(!page_is_aligned(start) || !page_is_aligned(len) ||
+      end <= start || end > VM_USER_END || vm->nr_rgn == VM_NR_RGN)
+      return -1;
+
+   for(i=0 ; i<vm->nr_rgn ; i++)
+      if(start < vm->rgn[i].end && vm->rgn[i].start < end)
+         return -1;
+
+   vm->rgn[vm->nr_rgn].start = start;
+   vm->rgn[vm->nr_rgn].end   = end;
+   vm->rgn[vm->nr_rgn].flags = flags;
+   vm->nr_rgn++;
+   return 0;
+}
+
+vm_rgn_t* vm_find(vm_t *vm, offset_t va)
+{
+   size_t i;
+
+   for(i=0 ; i<vm->nr_rgn ; i++)
+      if(mem_range(va, vm->rgn[i].start, vm->rgn[i].end))
+         return &vm->rgn[i];
+
+   return (vm_rgn_t*)0;
+}
+
+void vm_switch(vm_t *vm)
+{
+   vm_current = vm;
+   set_cr3(__pa(vm->pgd));
+}
+
+/*
+** Commit a zeroed frame on first touch of a reserved page
+*/
+static uint32_t __vm_fault_zero(int_ctx_t *ctx, offset_t addr)
+{
+   vm_rgn_t *rgn;
+   offset_t pa;
+   uint32_t attr;
+
+   if(!vm_current || ctx->err.pf.p || ctx->err.pf.rsv)
+      return VM_FLT_BAD;
+
+   rgn = vm_find(vm_current, addr);
+   if(!rgn || !(rgn->flags & VM_RGN_ZERO))
+      return VM_FLT_BAD;
+
+   if(ctx->err.pf.wr && !(rgn->flags & VM_RGN_RW))
+      return VM_FLT_BAD;
+
+   pa = pmem_alloc_zero();
+   if(!pa)
+      return VM_FLT_BAD;
+
+   attr = PG_USR|((rgn->flags & VM_RGN_RW) ? PG_RW : PG_RO);
+   if(vm_map(vm_current, page_align(addr), pa, attr) < 0)
+   {
+      pmem_put(pa);
+      return VM_FLT_BAD;
+   }
+
+   return VM_FLT_ZERO;
+}
+
+/*
+** Write to a copy-on-write page (from user or, with CR0.WP,
+** from kernel): copy the frame unless we are its last owner
+*/
+static uint32_t __vm_fault_cow(int_ctx_t *ctx, offset_t addr)
+{
+   pte32_t  *pte;
+   offset_t old, new;
+
+   if(!vm_current || !ctx->err.pf.wr || ctx->err.pf.rsv)
+      return VM_FLT_BAD;
+
+   if(addr >= VM_USER_END)
+      return VM_FLT_BAD;
+
+   pte = vm_get_pte(vm_current, addr);
+   if(!pte || !pg_present(pte) || !(pte->raw & VM_PG_COW))
+      return VM_FLT_BAD;
+
+   old = page_get_addr(pte->addr);
+
+   if(pmem_refs(old) == 1)
+   {
+      pte->raw &= ~VM_PG_COW;
+      pte->rw   = 1;
+      invalidate(addr);
+      return VM_FLT_COW_REUSE;
+   }
+
+   new = pmem_alloc();
+   if(!new)
+      return VM_FLT_BAD;
+
+   page_copy(__va(new), __va(old));
+
+   pte->raw &= ~VM_PG_COW;
+   pte->rw   = 1;
+   pte->addr = page_get_nr(new);
+   invalidate(addr);
+
+   pmem_put(old);
+   return VM_FLT_COW;
+}
+
+bool_t vm_fault(int_ctx_t *ctx)
+{
+   uint64_t       tsc  = cpu_rdtsc();
+   offset_t       addr = get_cr2();
+   vm_flt_stat_t  *st;
+   uint32_t       path;
+
+   if(ctx->err.pf.p)
+      path = __vm_fault_cow(ctx, addr);
+   else
+      path = __vm_fault_zero(ctx, addr);
+
+   st = &vm_flt_stats[path];
+
+   tsc = cpu_rdtsc() - tsc;
+   st->count++;
+   st->tsc += tsc;
+   if(tsc > st->max)
+      st->max = tsc;
+
+   return (path != VM_FLT_BAD);
+}
+
+void vm_stats()
+{
+   size_t i;
+
+   debug("\n-= VM faults =-\n");
+   for(i=0 ; i<VM_FLT_NR ; i++)
+   {
+      vm_flt_stat_t *st = &vm_flt_stats[i];
+      uint64_t      avg = st->tsc;
+
+      if(st->count)
+         div64(&avg, st->count);
+      else
+         avg = 0;
+
+      debug("%s: %d faults, %llu cycles (avg %llu, max %llu)\n"
+            ,vm_flt_names[i], st->count, st->tsc, avg, st->max);
+   }
+
+   pmem_stats();
+}
@@ -7,10 +7,75 @@
 #define force_interrupts_on()     asm volatile( "sti ; nop" )
 #define force_interrupts_off()    asm volatile( "cli" )
 #define halt()                    asm volatile( "cli ; hlt" )
+#define barrier()                 asm volatile( "":::"memory" )
 
 #define is_interrupts_enabled()         (get_flags() & EFLAGS_IF)
 #define disable_interrupts(flags)    ({save_flags(flags);force_interrupts_off();})
 #define enable_interrupts(flags)     ({save_flags(flags);force_interrupts_on();})
 #define restore_interrupts(flags)    load_flags(flags)
 
+/*
+** Time stamp counter
+*/
+#define rdtsc()                                                 \
+   ({                                                           \
+      uint64_t _t_;                                             \
+      asm volatile ("rdtsc":"=A"(_t_));                         \
+      _t_;                                                      \
+   })
+
+/*
+** 64 by 32 bits division with two hardware div,
+** quotient left in *n, remainder returned: keeps
+** libgcc __udivdi3 out of the kernel
+*/
+static inline uint32_t div64(uint64_t *n, uint32_t base)
+{
+   uint32_t hi = (uint32_t)(*n >> 32), lo = (uint32_t)*n;
+   uint32_t qh = 0, r;
+
+   if(hi >= base)
+   {
+      qh = hi / base;
+      hi = hi % base;
+   }
+
+   asm ("divl %4":"=a"(lo),"=d"(r):"a"(lo),"d"(hi),"r"(base));
+   *n = ((uint64_t)qh << 32) | lo;
+   return r;
+}
+
+/*
+** Atomic operations on 32 bits words
+*/
+#define cmpxchg(_p_,_old_,_new_)                                \
+   ({                                                           \
+      uint32_t _r_;                                             \
+      asm volatile ("lock cmpxchgl %2, %1"                      \
+                    :"=a"(_r_),"+m"(*(_p_))                     \
+                    :"r"(_new_),"0"(_old_)                      \
+                    :"memory");                                 \
+      _r_;                                                      \
+   })
+
+#define xchg(_p_,_v_)                                           \
+   ({                                                           \
+      uint32_t _r_ = (_v_);                                     \
+      asm volatile ("xchgl %0, %1"                              \
+                    :"+r"(_r_),"+m"(*(_p_))                     \
+                    ::"memory");                                \
+      _r_;                                                      \
+   })
+
+/*
+** Processor identification
+*/
+#define CPUID_EDX_SEP             (1<<11)
+#define CPUID_EBX_ERMS            (1<<9)      /* leaf 7 */
+
+#define cpuid(_leaf_,_a_,_b_,_c_,_d_)                           \
+   asm volatile ("cpuid"                                        \
+                 :"=a"(_a_),"=b"(_b_),"=c"(_c_),"=d"(_d_)       \
+                 :"a"(_leaf_),"c"(0))
+
 #endif
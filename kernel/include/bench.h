@@ -0,0 +1,53 @@
+/* GPLv2 (c) Airbus */
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include <types.h>
+#include <asm.h>
+#include <debug.h>
+
+/*
+** Cycle accounting for micro benchmarks,
+** built with "make BENCH=1" (CONFIG_BENCH)
+*/
+typedef struct bench
+{
+   uint32_t  count;
+   uint64_t  total;
+   uint64_t  min;
+   uint64_t  max;
+
+} bench_t;
+
+#define bench_init(_b_)                                 \
+   ({                                                   \
+      (_b_)->count = 0;                                 \
+      (_b_)->total = 0;                                 \
+      (_b_)->min   = ~0ULL;                             \
+      (_b_)->max   = 0;                                 \
+   })
+
+#define bench_add(_b_,_cycles_)                         \
+   ({                                                   \
+      uint64_t _c_ = (_cycles_);                        \
+      (_b_)->count++;                                   \
+      (_b_)->total += _c_;                              \
+      if(_c_ < (_b_)->min) (_b_)->min = _c_;            \
+      if(_c_ > (_b_)->max) (_b_)->max = _c_;            \
+   })
+
+#define bench_avg(_b_)                                  \
+   ({                                                   \
+      uint64_t _a_ = (_b_)->total;                      \
+      if((_b_)->count)                                  \
+         div64(&_a_, (_b_)->count);                     \
+      else                                              \
+         _a_ = 0;                                       \
+      _a_;                                              \
+   })
+
+#define bench_print(_name_,_b_)                                         \
+   debug("bench %s: %u runs, avg %llu min %llu max %llu cycles\n",      \
+         _name_, (_b_)->count, bench_avg(_b_), (_b_)->min, (_b_)->max)
+
+#endif
@@ -0,0 +1,40 @@
+/* GPLv2 (c) Airbus */
+#ifndef __CONSOLE_H__
+#define __CONSOLE_H__
+
+#include <types.h>
+#include <mbi.h>
+
+/*
+** Output backends under printf()
+*/
+typedef struct console
+{
+   char     *name;
+   int      (*probe)();                  /* null: always present */
+   size_t   (*write)(uint8_t*, size_t);
+   void     (*sync)();                   /* polled output (panic) */
+   void     (*flush)();                  /* push out the last bytes */
+
+} console_t;
+
+/*
+** The boot command line selects the backend
+** ("console=uart" or "console=debugcon"), else
+** CONFIG_DEBUGCON (make DEBUGCON=1) prefers the
+** debug port when it answers
+*/
+#define CONSOLE_OPT             "console="
+
+extern console_t *console;
+
+/*
+** Functions
+*/
+void    console_init(mbi_t*);
+int     console_select(char*);
+size_t  console_write(uint8_t*, size_t);
+void    console_sync();
+void    console_flush();
+
+#endif
@@ -0,0 +1,59 @@
+/* GPLv2 (c) Airbus */
+#ifndef __CPU_H__
+#define __CPU_H__
+
+#include <types.h>
+#include <asm.h>
+
+/*
+** Features, bit numbers of cpu_info_t.features
+*/
+#define CPU_TSC                 0
+#define CPU_PSE                 1
+#define CPU_PGE                 2
+#define CPU_APIC                3
+#define CPU_SEP                 4        /* sysenter/sysexit */
+#define CPU_FXSR                5
+#define CPU_SSE                 6
+#define CPU_SSE2                7
+#define CPU_ERMS                8        /* fast rep movsb/stosb */
+#define CPU_INVTSC              9        /* constant rate TSC */
+#define CPU_HYPERVISOR          10
+
+/*
+** CPUID bits
+*/
+#define CPUID_EDX_TSC           (1<<4)
+#define CPUID_EDX_PSE           (1<<3)
+#define CPUID_EDX_APIC          (1<<9)
+#define CPUID_EDX_PGE           (1<<13)
+#define CPUID_EDX_FXSR          (1<<24)
+#define CPUID_EDX_SSE           (1<<25)
+#define CPUID_EDX_SSE2          (1<<26)
+#define CPUID_ECX_HYPERVISOR    (1<<31)
+#define CPUID_EDX_INVTSC        (1<<8)   /* leaf 0x80000007 */
+
+typedef struct cpu_information
+{
+   char      vendor[13];
+   uint32_t  max_leaf;
+   uint32_t  family;
+   uint32_t  model;
+   uint32_t  stepping;
+   uint32_t  features;
+
+} __attribute__((packed)) cpu_info_t;
+
+#include <info.h>
+
+#define cpu_has(_f_)            (info->cpu.features & (1<<(_f_)))
+
+/*
+** Cycle counter, 0 on cpus without TSC
+*/
+#define cpu_rdtsc()             (cpu_has(CPU_TSC) ? rdtsc() : 0ULL)
+
+void     cpu_init();
+void     cpu_print();
+
+#endif
@@ -6,6 +6,10 @@
 #include <print.h>
 
 #define debug(format, ...) printf(format, ## __VA_ARGS__)
-void stack_trace(offset_t);
+
+#define STACK_TRACE_MAX    16
+
+void   stack_trace(offset_t);
+size_t stack_walk(offset_t, offset_t*, size_t);
 
 #endif
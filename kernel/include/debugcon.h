@@ -0,0 +1,23 @@
+/* GPLv2 (c) Airbus */
+#ifndef __DEBUGCON_H__
+#define __DEBUGCON_H__
+
+#include <types.h>
+#include <io.h>
+
+/*
+** QEMU/Bochs debug console: every byte written to
+** the port goes straight to the host chardev, no
+** line status to poll. Reads return the port number
+** when the device is present.
+*/
+#define DEBUGCON_PORT           0xe9
+
+#define debugcon_present()      (inb(DEBUGCON_PORT) == DEBUGCON_PORT)
+
+/*
+** Functions
+*/
+size_t  debugcon_write(uint8_t*, size_t);
+
+#endif
@@ -118,4 +118,11 @@ struct interrupt_context;
 
 void excp_hdlr(struct interrupt_context*) __regparm__(1);
 
+/*
+** Unresolved user mode page fault: stop the faulting
+** task, never returns. Weak: provided by the kernels
+** running tasks, the fault is fatal otherwise.
+*/
+void excp_user_kill(struct interrupt_context*) __attribute__((weak));
+
 #endif
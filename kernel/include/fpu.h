@@ -0,0 +1,23 @@
+/* GPLv2 (c) Airbus */
+#ifndef __FPU_H__
+#define __FPU_H__
+
+#include <types.h>
+
+/*
+** Kernel code never touches the fpu/sse registers
+** (-mno-sse) except between fpu_begin() and fpu_end():
+** the live state, whoever it belongs to, is saved and
+** restored around the section, interrupts are off.
+**
+** Sections do not nest.
+*/
+#define FPU_SAVE_SZ             512      /* fxsave area */
+
+extern bool_t fpu_sse;
+
+void  fpu_init();
+void  fpu_begin();
+void  fpu_end();
+
+#endif
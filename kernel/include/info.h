@@ -4,12 +4,16 @@
 
 #include <types.h>
 #include <mbi.h>
+#include <cpu.h>
 
 typedef struct information
 {
-   mbi_t *mbi;
+   mbi_t       *mbi;
+   cpu_info_t  cpu;
 
 } __attribute__((packed)) info_t;
 
+extern info_t *info;
+
 
 #endif
@@ -116,6 +116,8 @@ typedef struct interrupt_descriptor_table_register
    asm volatile ("lidt  %0"::"m"(val):"memory")
 
 void intr_init();
+void intr_dump(int_ctx_t*);
+void intr_irq_register(uint8_t, isr_t);
 void intr_hdlr(int_ctx_t*) __regparm__(1);
 
 #endif
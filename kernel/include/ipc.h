@@ -0,0 +1,55 @@
+/* GPLv2 (c) Airbus */
+#ifndef __IPC_H__
+#define __IPC_H__
+
+#include <types.h>
+#include <vm.h>
+
+/*
+** Message channels between address spaces.
+**
+** By default payload pages are moved from the sender
+** page tables to the receiver ones: the cost depends on
+** the number of pages, not on the number of bytes.
+*/
+#define IPC_NR_CHAN             4
+#define IPC_QUEUE_LEN           8
+#define IPC_MAX_PAGES           64
+
+#define IPC_LEND                (1<<0)   /* sender keeps a COW mapping */
+#define IPC_COPY                (1<<1)   /* copy through kernel frames */
+
+/*
+** Kernel chosen receive addresses
+*/
+#define IPC_VA_START            0x80000000UL
+#define IPC_VA_END              0xB0000000UL
+
+typedef struct ipc_message
+{
+   uint32_t  flags;
+   size_t    len;                        /* bytes */
+   size_t    nr_pages;
+   offset_t  frames[IPC_MAX_PAGES];
+   uint32_t  attrs[IPC_MAX_PAGES];       /* receiver PTE attributes */
+
+} ipc_msg_t;
+
+typedef struct ipc_channel
+{
+   uint32_t  head;
+   uint32_t  tail;                       /* tail - head pending messages */
+   ipc_msg_t msg[IPC_QUEUE_LEN];
+
+} ipc_chan_t;
+
+extern ipc_chan_t ipc_chans[IPC_NR_CHAN];
+
+/*
+** Functions
+*/
+int       ipc_send(ipc_chan_t*, vm_t*, offset_t, size_t, uint32_t);
+offset_t  ipc_recv(ipc_chan_t*, vm_t*, offset_t, size_t*);
+int       ipc_unmap(vm_t*, offset_t, size_t);
+
+#endif
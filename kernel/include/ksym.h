@@ -0,0 +1,32 @@
+/* GPLv2 (c) Airbus */
+#ifndef __KSYM_H__
+#define __KSYM_H__
+
+#include <types.h>
+
+/*
+** Code symbols of the kernel image, linked back into
+** it as the .ksym section (utils/ksymgen.py):
+**
+**  - __ksym_addr__[]  sorted addresses, the last entry
+**                     of each code section is unnamed
+**  - __ksym_names__   prefix compressed names, every
+**                     KSYM_BLOCK-th one stored whole at
+**                     __ksym_block__[i/KSYM_BLOCK]
+**
+** A lookup is a binary search on the addresses then
+** at most KSYM_BLOCK names to decode. Without the table
+** (first link) every lookup fails.
+*/
+#define KSYM_BLOCK              16
+#define KSYM_NAME_MAX           64
+
+/*
+** Functions
+*/
+int       ksym_find(offset_t);
+offset_t  ksym_addr(int);
+size_t    ksym_name(int, char*, size_t);
+int       ksym_lookup(offset_t, char*, size_t, offset_t*);
+
+#endif
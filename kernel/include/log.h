@@ -0,0 +1,112 @@
+/* GPLv2 (c) Airbus */
+#ifndef __LOG_H__
+#define __LOG_H__
+
+#include <types.h>
+#include <print.h>
+
+/*
+** Kernel log ring: writers reserve a record with a
+** compare-and-swap on the head, format into it and
+** publish it by storing its sequence number. A single
+** flusher copies published records to the console in
+** sequence order.
+**
+** Until log_defer() is enabled, writers flush right
+** after publishing (boot, tests without scheduler).
+*/
+#define LOG_NR_RECORDS          64       /* power of 2 */
+#define LOG_MSG_MAX             1024     /* as the former printf buffer */
+
+#define LOG_ERR                 0
+#define LOG_WARN                1
+#define LOG_INFO                2
+#define LOG_DEBUG               3
+
+#define LOG_REC_FAST            (1<<0)   /* msg holds fmt id and raw words */
+#define LOG_FAST_WORDS          8
+#define LOG_FAST_TAG            "#L"
+
+typedef struct log_record
+{
+   volatile uint32_t done;               /* seq+1 once published */
+   uint32_t  seq;
+   uint32_t  level;
+   uint32_t  flags;
+   uint32_t  len;                        /* bytes, or words if LOG_REC_FAST */
+   uint64_t  tsc;
+
+   union
+   {
+      char      msg[LOG_MSG_MAX];
+
+      struct
+      {
+         uint32_t  fmt;
+         uint32_t  args[LOG_FAST_WORDS];
+
+      } fast;
+   };
+
+} log_rec_t;
+
+/*
+** Binary logging: the format string goes to the .logfmt
+** section, which is not loaded (its offset is the id),
+** and only the raw argument words are recorded. Records
+** are flushed as "#L seq tsc id words..." lines that
+** utils/logdecode.py turns back into text using kernel.elf.
+**
+** At most LOG_FAST_WORDS words (64 bits arguments take two);
+** "%s" records the pointer, not the string.
+*/
+
+#define __log_w(_a_)            ((sizeof(_a_)+3)/4)
+#define __log_words_0()                 0
+#define __log_words_1(a)                __log_w(a)
+#define __log_words_2(a,b)              __log_w(a)+__log_w(b)
+#define __log_words_3(a,b,c)            __log_words_2(a,b)+__log_w(c)
+#define __log_words_4(a,b,c,d)          __log_words_3(a,b,c)+__log_w(d)
+#define __log_words_5(a,b,c,d,e)        __log_words_4(a,b,c,d)+__log_w(e)
+#define __log_words_6(a,b,c,d,e,f)      __log_words_5(a,b,c,d,e)+__log_w(f)
+#define __log_words_7(a,b,c,d,e,f,g)    __log_words_6(a,b,c,d,e,f)+__log_w(g)
+#define __log_words_8(a,b,c,d,e,f,g,h)  __log_words_7(a,b,c,d,e,f,g)+__log_w(h)
+
+#define __log_nargs(...)        __log_nargs_(_, ## __VA_ARGS__, 8,7,6,5,4,3,2,1,0)
+#define __log_nargs_(_,a,b,c,d,e,f,g,h,n,...) n
+#define __log_cat(a,b)          __log_cat_(a,b)
+#define __log_cat_(a,b)         a##b
+
+#define __log_words(...)                                        \
+   (__log_cat(__log_words_, __log_nargs(__VA_ARGS__))(__VA_ARGS__))
+
+#define log_fast(_fmt_, ...)                                            \
+   ({                                                                   \
+      static const char _f_[]                                           \
+         __attribute__((section(".logfmt"),used)) = _fmt_;              \
+      if(0) printf(_fmt_, ## __VA_ARGS__);  /* format checking only */  \
+      __log_fast((offset_t)_f_, __log_words(__VA_ARGS__), ## __VA_ARGS__); \
+   })
+
+typedef struct log_stats
+{
+   uint32_t  written;
+   uint32_t  dropped;                    /* ring full while flushing */
+   uint32_t  filtered;                   /* above log_level */
+
+} log_stats_t;
+
+extern log_stats_t log_stats;
+extern uint32_t    log_level;
+
+/*
+** Functions
+*/
+size_t  log_vprintf(uint32_t, const char*, va_list);
+size_t  log_printf(uint32_t, const char*, ...) __attribute__ ((__format__(__printf__, 2, 3)));
+void    __log_fast(offset_t, uint32_t, ...);
+void    log_flush();
+void    log_defer(bool_t);
+void    log_sync();
+
+#endif
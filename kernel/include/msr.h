@@ -0,0 +1,24 @@
+/* GPLv2 (c) Airbus */
+#ifndef __MSR_H__
+#define __MSR_H__
+
+#include <types.h>
+
+/*
+** Model specific registers
+*/
+#define IA32_SYSENTER_CS        0x174
+#define IA32_SYSENTER_ESP       0x175
+#define IA32_SYSENTER_EIP       0x176
+
+#define rd_msr(_msr_)                                           \
+   ({                                                           \
+      uint64_t _v_;                                             \
+      asm volatile ("rdmsr":"=A"(_v_):"c"(_msr_));              \
+      _v_;                                                      \
+   })
+
+#define wr_msr(_msr_,_val_)                                     \
+   asm volatile ("wrmsr"::"c"(_msr_),"A"((uint64_t)(_val_)))
+
+#endif
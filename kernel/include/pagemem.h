@@ -138,6 +138,17 @@ typedef union page_table_entry
 #define page_get_nr(addr)                pg_4K_get_nr((offset_t)addr)
 #define page_get_addr(bits)              pg_4K_get_addr((offset_t)bits)
 
+/*
+** Kernel virtual base, provided by the linker script
+** (null for identity mapped kernels)
+*/
+extern char __kernel_vma__[];
+extern char __boot_pgd__[];
+
+#define KERNEL_VMA                   ((offset_t)__kernel_vma__)
+#define __pa(_v_)                    ((offset_t)(_v_) - KERNEL_VMA)
+#define __va(_p_)                    ((void*)((offset_t)(_p_) + KERNEL_VMA))
+
 #define pg_present(_e_)              ((_e_)->p)
 #define pg_readable(_e_)             pg_present(_e_)
 #define pg_writable(_e_)             (pg_present(_e_) && ((_e_)->rw))
@@ -157,14 +168,76 @@ typedef union page_table_entry
    })
 
 #include <string.h>
-#define __clear_page(_d)             _memset32(_d,  0, PAGE_SIZE)
-#define __copy_page(_d,_s)           _memcpy32(_d, _s, PAGE_SIZE)
+#define __clear_page(_d)             _memset32(_d,  0, PAGE_SIZE/sizeof(uint32_t))
+#define __copy_page(_d,_s)           _memcpy32(_d, _s, PAGE_SIZE/sizeof(uint32_t))
+
+/*
+** SSE2 non-temporal stores, the page does not go through
+** the caches. Kernel code must wrap them in fpu_begin()
+** and fpu_end(), see page_clear() and page_copy()
+*/
+#ifdef __SSE__
+#define __page_nt_clobber            , "xmm0", "xmm1", "xmm2", "xmm3"
+#else
+#define __page_nt_clobber
+#endif
+
+#define __clear_page_nt(_d)                                             \
+   ({                                                                   \
+      ulong_t __d = (ulong_t)(_d);                                      \
+      ulong_t __n = PAGE_SIZE/64;                                       \
+      asm volatile ("pxor     %%xmm0, %%xmm0      \n"                   \
+                    "1:                           \n"                   \
+                    "movntdq  %%xmm0,   (%0)      \n"                   \
+                    "movntdq  %%xmm0, 16(%0)      \n"                   \
+                    "movntdq  %%xmm0, 32(%0)      \n"                   \
+                    "movntdq  %%xmm0, 48(%0)      \n"                   \
+                    "add      $64, %0             \n"                   \
+                    "dec      %1                  \n"                   \
+                    "jnz      1b                  \n"                   \
+                    "sfence                       \n"                   \
+                    :"+r"(__d),"+r"(__n)                                \
+                    ::"memory","cc" __page_nt_clobber);                 \
+   })
+
+#define __copy_page_nt(_d,_s)                                           \
+   ({                                                                   \
+      ulong_t __d = (ulong_t)(_d);                                      \
+      ulong_t __s = (ulong_t)(_s);                                      \
+      ulong_t __n = PAGE_SIZE/64;                                       \
+      asm volatile ("1:                           \n"                   \
+                    "prefetchnta 256(%1)          \n"                   \
+                    "movdqa     (%1), %%xmm0      \n"                   \
+                    "movdqa   16(%1), %%xmm1      \n"                   \
+                    "movdqa   32(%1), %%xmm2      \n"                   \
+                    "movdqa   48(%1), %%xmm3      \n"                   \
+                    "movntdq  %%xmm0,   (%0)      \n"                   \
+                    "movntdq  %%xmm1, 16(%0)      \n"                   \
+                    "movntdq  %%xmm2, 32(%0)      \n"                   \
+                    "movntdq  %%xmm3, 48(%0)      \n"                   \
+                    "add      $64, %0             \n"                   \
+                    "add      $64, %1             \n"                   \
+                    "dec      %2                  \n"                   \
+                    "jnz      1b                  \n"                   \
+                    "sfence                       \n"                   \
+                    :"+r"(__d),"+r"(__s),"+r"(__n)                      \
+                    ::"memory","cc" __page_nt_clobber);                 \
+   })
+
+/*
+** Page clear/copy, non-temporal when the cpu has SSE2
+*/
+extern bool_t page_nt;
+
+void  page_init();
+void  page_clear(void*);
+void  page_copy(void*, void*);
 
 /*
 ** Invalidate 32 bits TLB entry
 */
 #define invalidate(addr)             \
-   asm volatile ("invlpg %0"::"m"(addr):"memory")
+   asm volatile ("invlpg (%0)"::"r"(addr):"memory")
 
 
 #endif
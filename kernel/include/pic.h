@@ -23,6 +23,11 @@
 
 #define PIC_IRQ_NR            16
 
+/*
+** IDT vector of IRQ0 once remapped by pic_init()
+*/
+#define PIC_IRQ_BASE          32
+
 /*
 ** Devices linked to PICs
 */
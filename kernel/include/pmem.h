@@ -0,0 +1,60 @@
+/* GPLv2 (c) Airbus */
+#ifndef __PMEM_H__
+#define __PMEM_H__
+
+#include <types.h>
+#include <pagemem.h>
+
+/*
+** Physical frames handed out by the allocator:
+**
+**  [PMEM_START - PMEM_START + PMEM_NR_FRAMES*PAGE_SIZE[
+**
+** clamped to the amount of RAM reported by grub. Frames
+** must stay inside the kernel direct mapping (see __va).
+**
+** Every allocated frame holds a reference count, frames
+** outside of the pool (kernel image, ...) are not counted.
+*/
+#define PMEM_START              0x1000000UL
+#define PMEM_NR_FRAMES          16384
+
+#define pmem_frame_valid(_pa_)                                          \
+   mem_range((offset_t)(_pa_), PMEM_START, PMEM_START+PMEM_NR_FRAMES*PAGE_SIZE)
+
+#define pmem_frame_idx(_pa_)     page_get_nr((offset_t)(_pa_) - PMEM_START)
+
+/*
+** Pool of pre-zeroed frames served first by pmem_alloc_zero().
+** Once it drops under PMEM_ZERO_LOW, pmem_refill() (idle time,
+** timer tick) zeroes up to PMEM_ZERO_BATCH frames per call until
+** it is back to PMEM_ZERO_HIGH. pmem_alloc() falls back on it
+** when no other frame is left.
+*/
+#define PMEM_ZERO_HIGH          64
+#define PMEM_ZERO_LOW           16
+#define PMEM_ZERO_BATCH         4
+
+typedef struct pmem_zero_statistics
+{
+   uint32_t  hit;                  /* served from the pool */
+   uint32_t  miss;                 /* zeroed on the spot */
+   uint32_t  filled;               /* zeroed by pmem_refill() */
+
+} pmem_zero_stat_t;
+
+/*
+** Functions
+*/
+void     pmem_init();
+offset_t pmem_alloc();
+offset_t pmem_alloc_zero();
+offset_t pmem_alloc_contig(size_t);
+void     pmem_get(offset_t);
+void     pmem_put(offset_t);
+uint32_t pmem_refs(offset_t);
+size_t   pmem_nr_free();
+void     pmem_refill();
+void     pmem_stats();
+
+#endif
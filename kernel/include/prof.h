@@ -0,0 +1,53 @@
+/* GPLv2 (c) Airbus */
+#ifndef __PROF_H__
+#define __PROF_H__
+
+#include <types.h>
+#include <mbi.h>
+
+/*
+** Sampling profiler: each timer tick records the
+** interrupted pc, its privilege level and the frame
+** pointer call chain in a ring buffer. prof_dump()
+** prints one "#P" line per sample, utils/profsym.py
+** turns them into folded stacks.
+**
+** "prof" on the boot command line starts it at boot
+*/
+#define PROF_RING_LEN           1024     /* power of 2 */
+#define PROF_DEPTH              8        /* pc and callers */
+#define PROF_OPT                "prof"
+#define PROF_TAG                "#P"
+
+#define PROF_OFF                0
+#define PROF_ON                 1
+#define PROF_DUMP               2
+#define PROF_RESET              3
+
+typedef struct prof_sample
+{
+   uint32_t  pid;
+   uint32_t  cpl;
+   uint32_t  depth;
+   offset_t  pc[PROF_DEPTH];
+
+} prof_sample_t;
+
+/*
+** Tested by the timer handler: a stopped
+** profiler costs a single load and branch
+*/
+extern volatile uint32_t prof_enabled;
+
+#define prof_on()               (prof_enabled)
+
+/*
+** Functions
+*/
+void      prof_init(mbi_t*);
+void      prof_enable(uint32_t);
+void      prof_reset();
+void      prof_sample(uint32_t, offset_t, uint32_t, offset_t);
+void      prof_dump();
+
+#endif
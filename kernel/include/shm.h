@@ -0,0 +1,46 @@
+/* GPLv2 (c) Airbus */
+#ifndef __SHM_H__
+#define __SHM_H__
+
+#include <types.h>
+#include <vm.h>
+
+/*
+** Shared memory objects, identified by a user chosen key.
+**
+** An object owns one reference on each of its frames,
+** every mapping takes another one. The object itself is
+** released when its last mapping goes away, or by
+** shm_destroy() if it was never mapped.
+*/
+#define SHM_NR_OBJ              16
+#define SHM_MAX_PAGES           64
+
+#define SHM_CONTIG              (1<<0)   /* physically contiguous frames */
+
+/*
+** Kernel chosen mapping addresses
+*/
+#define SHM_VA_START            0x40000000UL
+#define SHM_VA_END              0x80000000UL
+
+typedef struct shm_object
+{
+   uint32_t  key;
+   uint32_t  flags;
+   uint32_t  refs;                       /* mappings */
+   size_t    nr_pages;                   /* 0 means free slot */
+   offset_t  frames[SHM_MAX_PAGES];
+
+} shm_t;
+
+/*
+** Functions
+*/
+int       shm_create(uint32_t, size_t, uint32_t);
+offset_t  shm_map(vm_t*, int, offset_t);
+int       shm_unmap(vm_t*, offset_t);
+int       shm_destroy(int);
+void      shm_dup(offset_t);
+
+#endif
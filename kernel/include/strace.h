@@ -0,0 +1,62 @@
+/* GPLv2 (c) Airbus */
+#ifndef __STRACE_H__
+#define __STRACE_H__
+
+#include <types.h>
+
+/*
+** System call tracing: every traced call is logged
+** in a ring buffer and accounted in a per-number
+** log2 latency histogram (bucket b holds durations
+** in [2^(b+STRACE_HIST_SHIFT), 2^(b+1+STRACE_HIST_SHIFT)[,
+** the first and last buckets are open ended)
+*/
+#define STRACE_RING_LEN         256      /* power of 2 */
+#define STRACE_NR_SYS           32
+#define STRACE_NR_BUCKETS       16
+#define STRACE_HIST_SHIFT       6
+
+#define STRACE_OFF              0
+#define STRACE_ON               1
+#define STRACE_DUMP             2
+#define STRACE_RESET            3
+
+typedef struct strace_rec
+{
+   uint32_t  pid;
+   uint32_t  nr;
+   uint32_t  args[5];
+   uint32_t  ret;
+   uint32_t  cycles;
+   uint64_t  tsc;                        /* entry time */
+
+} strace_rec_t;
+
+typedef struct strace_hist
+{
+   uint32_t  count;
+   uint32_t  min;
+   uint32_t  max;
+   uint64_t  total;
+   uint32_t  buckets[STRACE_NR_BUCKETS];
+
+} strace_hist_t;
+
+/*
+** Tested by the dispatcher before reading the TSC:
+** a disabled tracer costs a single load and branch
+*/
+extern volatile uint32_t strace_enabled;
+
+#define strace_on()             (strace_enabled)
+
+/*
+** Functions
+*/
+void      strace_enable(uint32_t);
+void      strace_reset();
+void      strace_record(uint32_t, uint32_t, uint32_t*, uint32_t,
+                        uint64_t, uint64_t);
+void      strace_dump();
+
+#endif
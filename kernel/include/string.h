@@ -5,21 +5,11 @@
 #include <types.h>
 #include <gpr.h>
 
-#define __divrm(a,b,r,m)                                                \
-   asm volatile ("div %%ecx":"=a"(r),"=d"(m):"a"(a),"d"(0),"c"(b))
-
 /*
-** Size is number of store operations to repeat
+** The direction flag is clear in kernel code: at boot (entry.s)
+** and on every kernel entry (idt.s, syscall gates), as the C
+** calling convention requires. String operations rely on it.
 */
-#define __fix_str_dir(__op__,a,b,c,l)           \
-   ({                                           \
-      eflags_reg_t save;                        \
-      save_flags(save);                         \
-      asm volatile ("cld");                     \
-      __op__(a,b,c,l);                          \
-      load_flags(save);                         \
-   })
-
 #define  __rep_8_16(b) ((((uint16_t)b)<<8)|((uint16_t)b))
 #define  __rep_8_32(b) ((((uint32_t)__rep_8_16(b))<<16)|((uint32_t)__rep_8_16(b)))
 
@@ -28,75 +18,100 @@
 
 #define __replicate_byte_on_long(b) __rep_8_32(b)
 
-#define __memset8(d,v,t,l)  asm volatile ("rep stosb"::"D"(d),"a"(v),"c"(t))
-#define __memcpy8(d,s,t,l)  asm volatile ("rep movsb"::"D"(d),"S"(s),"c"(t))
+/*
+** Registers are advanced by the string operation: work on copies
+*/
+#define __rep_str(_i_,d,s,t)                                            \
+   ({                                                                   \
+      ulong_t __d = (ulong_t)(d), __s = (ulong_t)(s), __t = (t);        \
+      asm volatile (_i_:"+D"(__d),"+S"(__s),"+c"(__t)::"memory");       \
+   })
+
+#define __rep_sto(_i_,d,v,t)                                            \
+   ({                                                                   \
+      ulong_t __d = (ulong_t)(d), __t = (t);                            \
+      asm volatile (_i_:"+D"(__d),"+c"(__t):"a"(v):"memory");           \
+   })
+
+#define __memset8(d,v,t,l)  __rep_sto("rep stosb",d,v,t)
+#define __memcpy8(d,s,t,l)  __rep_str("rep movsb",d,s,t)
 #define __memchr8(d,s,v,l)  asm volatile ("repnz scasb":"=D"(d), "=c"(l):"D"(s),"a"(v),"c"(l))
 
-#define _memset8(d,v,t)     __fix_str_dir(__memset8,d,v,t,0)
-#define _memcpy8(d,s,t)     __fix_str_dir(__memcpy8,d,s,t,0)
-#define _memchr8(d,s,v,l)   __fix_str_dir(__memchr8,d,s,v,l)
+#define _memset8(d,v,t)     __memset8(d,v,t,0)
+#define _memcpy8(d,s,t)     __memcpy8(d,s,t,0)
+#define _memchr8(d,s,v,l)   __memchr8(d,s,v,l)
 
-#define __memset32(d,v,t,l)  asm volatile ("rep stosl"::"D"(d),"a"(v),"c"(t))
-#define __memcpy32(d,s,t,l)  asm volatile ("rep movsl"::"D"(d),"S"(s),"c"(t))
+#define __memset32(d,v,t,l)  __rep_sto("rep stosl",d,v,t)
+#define __memcpy32(d,s,t,l)  __rep_str("rep movsl",d,s,t)
 #define __memchr32(d,s,v,l)  asm volatile ("repnz scasl":"=D"(d), "=c"(l):"D"(s),"a"(v),"c"(l))
 
-#define _memset32(d,v,t)     __fix_str_dir(__memset32,d,v,t,0)
-#define _memcpy32(d,s,t)     __fix_str_dir(__memcpy32,d,s,t,0)
-#define _memchr32(d,s,v,l)   __fix_str_dir(__memchr32,d,s,v,l)
+#define _memset32(d,v,t)     __memset32(d,v,t,0)
+#define _memcpy32(d,s,t)     __memcpy32(d,s,t,0)
+#define _memchr32(d,s,v,l)   __memchr32(d,s,v,l)
 
 /*
 ** Size is number of bytes
+**
+** Compile-time constant sizes up to STRING_INLINE_MAX are
+** expanded in place, other ones go to kernel/core/string.c
 */
-static inline void* memset(void *dst, uint8_t c, size_t size)
-{
-   size_t cnt, rm;
-   loc_t  dloc;
-
-   dloc.addr = dst;
-
-   if(!size)
-      return dst;
-
-   __divrm(size, sizeof(ulong_t), cnt, rm);
-
-   if(cnt)
-   {
-      ulong_t lc = __replicate_byte_on_long(c);
-      _memset32(dloc.linear, lc, cnt);
-      dloc.linear += cnt*sizeof(ulong_t);
-   }
-
-   if(rm)
-      _memset8(dloc.linear, c, rm);
-
-   return dst;
-}
-
-static inline void* memcpy(void *dst, void *src, size_t size)
-{
-   size_t cnt, rm;
-   loc_t  dloc, sloc;
-
-   dloc.addr = dst;
-   sloc.addr = src;
-
-   if(!size)
-      return dst;
+#define STRING_INLINE_MAX    32
+
+typedef uint32_t __attribute__((__may_alias__,__aligned__(1))) __str32_t;
+typedef uint16_t __attribute__((__may_alias__,__aligned__(1))) __str16_t;
+
+#define __memcpy_const(_d_,_s_,_n_)                                     \
+   ({                                                                   \
+      void          *__r = (_d_);                                       \
+      uint8_t       *__d = (uint8_t*)__r;                               \
+      const uint8_t *__s = (const uint8_t*)(_s_);                       \
+      size_t        __i, __w = (_n_)/4;                                 \
+                                                                        \
+      for(__i=0 ; __i<__w ; __i++)                                      \
+         ((__str32_t*)__d)[__i] = ((const __str32_t*)__s)[__i];         \
+      if((_n_) & 2)                                                     \
+         *(__str16_t*)&__d[(_n_)&~3] = *(const __str16_t*)&__s[(_n_)&~3]; \
+      if((_n_) & 1)                                                     \
+         __d[(_n_)-1] = __s[(_n_)-1];                                   \
+      __r;                                                              \
+   })
 
-   __divrm(size, sizeof(ulong_t), cnt, rm);
+#define __memset_const(_d_,_c_,_n_)                                     \
+   ({                                                                   \
+      void     *__r = (_d_);                                            \
+      uint8_t  *__d = (uint8_t*)__r;                                    \
+      uint32_t __v = __replicate_byte_on_dword((uint8_t)(_c_));         \
+      size_t   __i, __w = (_n_)/4;                                      \
+                                                                        \
+      for(__i=0 ; __i<__w ; __i++)                                      \
+         ((__str32_t*)__d)[__i] = __v;                                  \
+      if((_n_) & 2)                                                     \
+         *(__str16_t*)&__d[(_n_)&~3] = (uint16_t)__v;                   \
+      if((_n_) & 1)                                                     \
+         __d[(_n_)-1] = (uint8_t)__v;                                   \
+      __r;                                                              \
+   })
 
-   if(cnt)
-   {
-      _memcpy32(dloc.linear, sloc.linear, cnt);
-      dloc.linear += cnt*sizeof(ulong_t);
-      sloc.linear += cnt*sizeof(ulong_t);
-   }
+#define memcpy(_d_,_s_,_n_)                                             \
+   (__builtin_constant_p(_n_) && (_n_) <= STRING_INLINE_MAX             \
+    ? __memcpy_const(_d_,_s_,_n_) : __memcpy(_d_,_s_,_n_))
 
-   if(rm)
-      _memcpy8(dloc.linear, sloc.linear, rm);
+#define memset(_d_,_c_,_n_)                                             \
+   (__builtin_constant_p(_n_) && (_n_) <= STRING_INLINE_MAX             \
+    ? __memset_const(_d_,_c_,_n_) : __memset(_d_,_c_,_n_))
 
-   return dst;
-}
+/*
+** Fast "rep movsb/stosb" (ERMS), selected by string_init()
+** from the cpu features
+*/
+extern bool_t string_erms;
+
+void     string_init();
+void*    __memcpy(void*, const void*, size_t);
+void*    __memset(void*, uint8_t, size_t);
+void*    memmove(void*, const void*, size_t);
+int      memcmp(const void*, const void*, size_t);
+int      strncmp(const char*, const char*, size_t);
 
 static inline char* strchr(char *str, size_t len, char c)
 {
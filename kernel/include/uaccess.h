@@ -0,0 +1,40 @@
+/* GPLv2 (c) Airbus */
+#ifndef __UACCESS_H__
+#define __UACCESS_H__
+
+#include <types.h>
+#include <vm.h>
+
+/*
+** Exception table: a fault raised by the instruction
+** at "insn" resumes at "fixup" instead of panicking
+*/
+typedef struct exception_table_entry
+{
+   offset_t  insn;
+   offset_t  fixup;
+
+} __attribute__((packed)) ex_entry_t;
+
+extern ex_entry_t __ex_table_start__[];
+extern ex_entry_t __ex_table_end__[];
+
+/*
+** Only the range is checked, the mapping is not walked:
+** faults are turned into error returns
+*/
+#define uaccess_ok(_p_,_len_)                                   \
+   ((offset_t)(_p_) + (_len_) >= (offset_t)(_p_) &&             \
+    (offset_t)(_p_) + (_len_) <= VM_USER_END)
+
+/*
+** Functions, copies return the number of bytes
+** not copied, get/put return 0 or -1
+*/
+size_t    copy_from_user(void*, const void*, size_t);
+size_t    copy_to_user(void*, const void*, size_t);
+int       get_user(uint32_t*, const uint32_t*);
+int       put_user(uint32_t, uint32_t*);
+bool_t    uaccess_fixup(int_ctx_t*);
+
+#endif
@@ -307,6 +307,21 @@ typedef union serial_dla
 } __attribute__((packed)) serial_dla_t;
 
 
+/*
+** Line settings, may be overridden at build time
+** (eg. CFLAGS += -DUART_BAUD=38400)
+*/
+#define UART_CLOCK              115200   /* 1.8432 MHz / 16 */
+#define UART_FIFO_LEN           16
+
+#ifndef UART_BAUD
+#define UART_BAUD               115200
+#endif
+
+#ifndef UART_RX_TRIGGER
+#define UART_RX_TRIGGER         SERIAL_FCR_RX_FIFO_8
+#endif
+
 /*
 ** Functions
 */
@@ -320,9 +335,57 @@ typedef union serial_dla
 #define uart_set_msb_dla_rate(BASE,x)       out( (x),  SERIAL_DLA_MSB((BASE)) )
 #define uart_enable_efr_registers(BASE)     out( 0xbf, SERIAL_LCR((BASE)) )
 
+/*
+** Interrupt driven transmit: uart_write() queues into
+** a ring drained by the THR empty interrupt (IRQ4).
+** Until uart_tx_async() is called, or after uart_sync(),
+** uart_write() polls the line status for every byte.
+*/
+#define UART_TX_RING_LEN        4096     /* power of 2 */
+
+#define UART_TX_DROP            0        /* discard what does not fit */
+#define UART_TX_BLOCK           1        /* wait for the irq handler */
+#define UART_TX_POLL            2        /* send the excess synchronously */
+
+typedef struct uart_tx_stats
+{
+   uint32_t  queued;                     /* bytes through the ring */
+   uint32_t  dropped;                    /* UART_TX_DROP losses */
+   uint32_t  polled;                     /* bytes sent by the writer itself */
+   uint32_t  irqs;
+
+} uart_tx_stats_t;
+
+extern uart_tx_stats_t uart_tx_stats;
+
+/*
+** Interrupt driven receive: once uart_rx_async() is called,
+** the irq handler empties the rx fifo into a ring and
+** uart_read() only consumes from it (never blocks):
+** readers sleep on uart_rx_notify()
+*/
+#define UART_RX_RING_LEN        1024     /* power of 2 */
+
+typedef struct uart_rx_stats
+{
+   uint32_t  received;
+   uint32_t  overruns;                   /* lost, ring full */
+   uint32_t  hw_overruns;                /* lost, fifo full (LSR.OE) */
+   uint32_t  errors;                     /* parity, framing, break */
+
+} uart_rx_stats_t;
+
+extern uart_rx_stats_t uart_rx_stats;
+
 void    uart_init();
+int     uart_set_baud(uint32_t);
+void    uart_set_fifo(bool_t);
 size_t  uart_read(uint8_t*, size_t);
 size_t  uart_write(uint8_t*, size_t);
 void    uart_flush();
+void    uart_tx_async(uint32_t);
+void    uart_rx_async();
+void    uart_rx_notify(void (*)(void));
+void    uart_sync();
 
 #endif
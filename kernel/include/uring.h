@@ -0,0 +1,73 @@
+/* GPLv2 (c) Airbus */
+#ifndef __URING_H__
+#define __URING_H__
+
+#include <types.h>
+#include <asm.h>
+#include <vm.h>
+
+/*
+** Asynchronous syscall submission: one page shared by a
+** task and the kernel holds a submission ring (filled by
+** the task) and a completion ring (filled by the kernel).
+**
+** Indexes are free running, entries are taken modulo
+** URING_ENTRIES. Each side only writes its own indexes.
+*/
+#define URING_ENTRIES           64
+
+#define URING_SQPOLL            (1<<0)   /* drained on scheduler ticks */
+
+/*
+** Kernel chosen ring addresses
+*/
+#define URING_VA_START          0xB0000000UL
+#define URING_VA_END            0xB0400000UL
+
+typedef struct uring_submission_entry
+{
+   uint32_t  nr;                         /* syscall number */
+   uint32_t  args[5];
+   uint32_t  user_data;                  /* copied to the completion */
+
+} uring_sqe_t;
+
+typedef struct uring_completion_entry
+{
+   uint32_t  user_data;
+   uint32_t  res;
+
+} uring_cqe_t;
+
+typedef struct uring
+{
+   volatile uint32_t sq_head;            /* kernel */
+   volatile uint32_t sq_tail;            /* task */
+   volatile uint32_t cq_head;            /* task */
+   volatile uint32_t cq_tail;            /* kernel */
+
+   uring_sqe_t       sq[URING_ENTRIES];
+   uring_cqe_t       cq[URING_ENTRIES];
+
+} uring_t;
+
+typedef uint32_t (*uring_exec_t)(uring_sqe_t*);
+
+/*
+** Task side helpers (macros: usable from user sections)
+*/
+#define uring_sq_full(_r_)      ((_r_)->sq_tail - (_r_)->sq_head == URING_ENTRIES)
+#define uring_sqe_next(_r_)     (&(_r_)->sq[(_r_)->sq_tail % URING_ENTRIES])
+#define uring_sq_push(_r_)      ({ barrier(); (_r_)->sq_tail++; })
+
+#define uring_cq_empty(_r_)     ((_r_)->cq_head == (_r_)->cq_tail)
+#define uring_cqe_next(_r_)     (&(_r_)->cq[(_r_)->cq_head % URING_ENTRIES])
+#define uring_cq_pop(_r_)       ({ barrier(); (_r_)->cq_head++; })
+
+/*
+** Functions
+*/
+uring_t*  uring_create(vm_t*, offset_t*);
+size_t    uring_drain(uring_t*, uring_exec_t);
+
+#endif
@@ -0,0 +1,97 @@
+/* GPLv2 (c) Airbus */
+#ifndef __VDSO_H__
+#define __VDSO_H__
+
+#include <types.h>
+#include <asm.h>
+#include <vm.h>
+
+/*
+** Kernel data page, mapped read-only at VDSO_VA in every
+** address space: tasks read it without entering the kernel.
+**
+** Updates are bracketed by an odd/even sequence counter,
+** readers retry when it moved (seqlock).
+*/
+#define VDSO_VA                 0xBFF00000UL
+#define VDSO_NR_TASKS           8
+
+/*
+** ns = ns_base + ((tsc - tsc_base) * mult) >> VDSO_SHIFT
+*/
+#define VDSO_SHIFT              24
+
+typedef struct vdso_task
+{
+   uint32_t  pid;
+   uint32_t  switches;                   /* times scheduled in */
+   uint64_t  tsc;                        /* cycles spent running */
+   uint64_t  tsc_in;                     /* TSC when scheduled in */
+
+} vdso_task_t;
+
+typedef struct vdso_data
+{
+   volatile uint32_t seq;
+
+   uint32_t  features;                   /* cpu_has() bits */
+   uint32_t  tsc_khz;                    /* calibrated against the PIT */
+   uint32_t  mult;                       /* 0: clock from timer ticks */
+   uint64_t  tsc_base;                   /* TSC at last update */
+   uint64_t  ns_base;                    /* monotonic clock at tsc_base */
+   uint64_t  ticks;                      /* timer interrupts */
+
+   uint32_t  pid;                        /* running task */
+   uint32_t  nr_tasks;
+   vdso_task_t tasks[VDSO_NR_TASKS];
+
+} vdso_t;
+
+extern vdso_t *vdso;
+
+/*
+** Reader side (macros: usable from user sections)
+*/
+#define vdso_read_begin(_v_)                                    \
+   ({                                                           \
+      uint32_t _s_;                                             \
+      while((_s_ = (_v_)->seq) & 1);                            \
+      barrier();                                                \
+      _s_;                                                      \
+   })
+
+#define vdso_read_retry(_v_,_s_)                                \
+   ({ barrier(); (_v_)->seq != (_s_); })
+
+#define vdso_getpid(_v_)                                        \
+   ({                                                           \
+      uint32_t _s_, _p_;                                        \
+      do { _s_ = vdso_read_begin(_v_); _p_ = (_v_)->pid; }      \
+      while(vdso_read_retry(_v_,_s_));                          \
+      _p_;                                                      \
+   })
+
+#define vdso_clock_ns(_v_)                                      \
+   ({                                                           \
+      uint32_t _s_, _d_;                                        \
+      uint64_t _n_;                                             \
+      do {                                                      \
+         _s_ = vdso_read_begin(_v_);                            \
+         _d_ = (_v_)->mult ?                                    \
+            (uint32_t)(rdtsc() - (_v_)->tsc_base) : 0;          \
+         _n_ = (_v_)->ns_base +                                 \
+            (((uint64_t)_d_ * (_v_)->mult) >> VDSO_SHIFT);      \
+      } while(vdso_read_retry(_v_,_s_));                        \
+      _n_;                                                      \
+   })
+
+/*
+** Functions
+*/
+void      vdso_init();
+int       vdso_map(vm_t*);
+void      vdso_tick();
+void      vdso_switch(uint32_t);
+void      vdso_stats();
+
+#endif
@@ -0,0 +1,86 @@
+/* GPLv2 (c) Airbus */
+#ifndef __VM_H__
+#define __VM_H__
+
+#include <types.h>
+#include <pagemem.h>
+#include <intr.h>
+
+/*
+** User address space: [0 - KERNEL_VMA[
+*/
+#define VM_USER_END             KERNEL_VMA
+
+/*
+** Address space regions (reserved, committed on first touch)
+*/
+#define VM_NR_RGN               8
+
+#define VM_RGN_RW               (1<<0)   /* writable */
+#define VM_RGN_ZERO             (1<<1)   /* demand-zero frames */
+
+typedef struct vm_region
+{
+   offset_t  start;
+   offset_t  end;                        /* excluded */
+   uint32_t  flags;
+
+} vm_rgn_t;
+
+typedef struct vm_address_space
+{
+   pde32_t   *pgd;                       /* kernel virtual address */
+   vm_rgn_t  rgn[VM_NR_RGN];
+   size_t    nr_rgn;
+
+} vm_t;
+
+/*
+** Beyond this number of pages, reload CR3 instead of invlpg
+*/
+#define VM_FLUSH_MAX            32
+
+/*
+** PTE available bits
+*/
+#define VM_PG_COW               (1<<9)   /* read-only until first write */
+#define VM_PG_SHR               (1<<10)  /* shared mapping, never COW */
+
+/*
+** Page fault paths accounting
+*/
+#define VM_FLT_ZERO             0        /* demand-zero frame committed */
+#define VM_FLT_COW              1        /* private copy of a shared frame */
+#define VM_FLT_COW_REUSE        2        /* last owner, write enabled */
+#define VM_FLT_BAD              3        /* not resolved */
+#define VM_FLT_NR               4
+
+typedef struct vm_fault_statistics
+{
+   uint32_t  count;
+   uint64_t  tsc;                        /* cumulated cycles */
+   uint64_t  max;
+
+} vm_flt_stat_t;
+
+extern vm_t          *vm_current;
+extern vm_flt_stat_t  vm_flt_stats[VM_FLT_NR];
+
+/*
+** Functions
+*/
+void      vm_init(vm_t*);
+int       vm_clone(vm_t*, vm_t*);
+int       vm_map(vm_t*, offset_t, offset_t, uint32_t);
+offset_t  vm_unmap(vm_t*, offset_t);
+void      vm_flush(vm_t*, offset_t, size_t);
+bool_t    vm_range_free(vm_t*, offset_t, size_t);
+offset_t  vm_find_free(vm_t*, offset_t, offset_t, size_t);
+pte32_t*  vm_get_pte(vm_t*, offset_t);
+int       vm_reserve(vm_t*, offset_t, size_t, uint32_t);
+vm_rgn_t* vm_find(vm_t*, offset_t);
+void      vm_switch(vm_t*);
+bool_t    vm_fault(int_ctx_t*);
+void      vm_stats();
+
+#endif
@@ -0,0 +1,132 @@
+/* GPLv2 (c) Airbus */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "test.h"
+
+/*
+** Host throughput of the kernel string.h and formatter,
+** next to the host libc for scale
+*/
+size_t krn_snprintf(char*, size_t, const char*, ...);
+
+#define BENCH_BYTES     (64UL<<20)      /* moved per size */
+#define BENCH_FMT_RUNS  200000UL
+#define BENCH_MAX_SIZE  (64UL<<10)
+
+static uint8_t bsrc[BENCH_MAX_SIZE+64] __attribute__((aligned(64)));
+static uint8_t bdst[BENCH_MAX_SIZE+64] __attribute__((aligned(64)));
+
+static double now()
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+typedef void* (*copy_t)(void*, void*, unsigned long);
+typedef void* (*fill_t)(void*, unsigned char, unsigned long);
+
+static void* libc_memcpy(void *d, void *s, unsigned long n)
+{
+   return memcpy(d, s, n);
+}
+
+/*
+** MB/s of nr calls on size bytes, dst offset by mis bytes
+*/
+static double bench_copy(copy_t fn, size_t size, size_t mis)
+{
+   unsigned long i, nr = BENCH_BYTES/size;
+   copy_t volatile f = fn;
+   double t = now();
+
+   for(i=0 ; i<nr ; i++)
+      f(&bdst[mis], bsrc, size);
+
+   return (nr*size)/(now()-t)/1e6;
+}
+
+static double bench_fill(fill_t fn, size_t size, size_t mis)
+{
+   unsigned long i, nr = BENCH_BYTES/size;
+   fill_t volatile f = fn;
+   double t = now();
+
+   for(i=0 ; i<nr ; i++)
+      f(&bdst[mis], (unsigned char)i, size);
+
+   return (nr*size)/(now()-t)/1e6;
+}
+
+/*
+** Kernel memcpy with and without the ERMS path,
+** misaligned destination, libc memcpy, kernel memset
+*/
+void bench_string()
+{
+   double copy, erms, mis, libc, fill;
+   size_t size;
+   int    save = kstring_erms(0);
+
+   printf("%-8s %8s %10s %10s %10s %10s %10s\n", "MB/s", "size",
+          "kmemcpy", "kerms", "kmemcpy+1", "memcpy", "kmemset");
+
+   for(size=1 ; size<=BENCH_MAX_SIZE ; size*=2)
+   {
+      kstring_erms(0);
+      copy = bench_copy(kstring_memcpy, size, 0);
+      mis  = bench_copy(kstring_memcpy, size, 1);
+      fill = bench_fill(kstring_memset, size, 0);
+      kstring_erms(1);
+      erms = bench_copy(kstring_memcpy, size, 0);
+      libc = bench_copy(libc_memcpy, size, 0);
+
+      printf("%-8s %8zu %10.0f %10.0f %10.0f %10.0f %10.0f\n", "string",
+             size, copy, erms, mis, libc, fill);
+   }
+
+   kstring_erms(save);
+}
+
+/*
+** Every format takes (unsigned, char*, unsigned long long),
+** unused trailing arguments are ignored
+*/
+static const char *formats[] = {
+   "%u",
+   "cr3 0x%08x task %s\n",
+   "pid %-5u task %-8s\n",
+   "Valeur compteur: %u (%s) tsc %llu\n",
+   "Passage en mode utilisateur\n",
+};
+
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+#pragma GCC diagnostic ignored "-Wformat-extra-args"
+
+#define bench_fmt_loop(_fn_,_f_)                                        \
+   ({                                                                   \
+      char          buf[128];                                           \
+      unsigned long i;                                                  \
+      double        t = now();                                          \
+                                                                        \
+      for(i=0 ; i<BENCH_FMT_RUNS ; i++)                                 \
+         _fn_(buf, sizeof(buf), _f_, (unsigned)i*2654435761U,           \
+              "console", (unsigned long long)i << 20);                  \
+      (now()-t)*1e9/BENCH_FMT_RUNS;                                     \
+   })
+
+void bench_format()
+{
+   unsigned long f;
+
+   printf("%-8s %10s %10s  %s\n", "ns/call", "kernel", "libc", "format");
+
+   for(f=0 ; f<sizeof(formats)/sizeof(formats[0]) ; f++)
+      printf("%-8s %10.1f %10.1f  \"%.*s\"\n", "format",
+             bench_fmt_loop(krn_snprintf, formats[f]),
+             bench_fmt_loop(snprintf, formats[f]),
+             (int)strcspn(formats[f], "\n"), formats[f]);
+}
@@ -0,0 +1,191 @@
+/* GPLv2 (c) Airbus */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "test.h"
+
+/*
+** Random formats are built from the conversions where the
+** kernel and C99 agree, then formatted by both __vsnprintf()
+** (through the kernel snprintf) and the host vsnprintf.
+**
+** Left out: the kernel specific %X %D %b %B %p, a lone 'l'
+** (32 bits in the kernel), '0' with %s/%c.
+*/
+size_t krn_snprintf(char*, size_t, const char*, ...);
+
+#define FMT_LEN     96
+#define OUT_LEN     160
+#define CANARY      0x5c
+
+typedef enum { ARG_INT, ARG_LL, ARG_STR } arg_t;
+
+static uint64_t rnd_state;
+
+static uint32_t rnd()
+{
+   /* xorshift64* */
+   rnd_state ^= rnd_state >> 12;
+   rnd_state ^= rnd_state << 25;
+   rnd_state ^= rnd_state >> 27;
+   return (uint32_t)((rnd_state * 0x2545f4914f6cdd1dULL) >> 32);
+}
+
+static const char *strs[] = {
+   "", "a", "secos", "kernel.elf", "0123456789abcdefghij",
+};
+
+typedef struct fuzz_case
+{
+   char        fmt[FMT_LEN];
+   arg_t       type;
+   int         nr_star;
+   int         star[2];
+   uint64_t    val;
+   const char  *str;
+
+} fuzz_case_t;
+
+static size_t add_text(char *p)
+{
+   size_t n = rnd() % 6, i;
+
+   for(i=0 ; i<n ; i++)
+   {
+      p[i] = ' ' + rnd() % 95;
+      if(p[i] == '%')
+         p[i] = '_';
+   }
+
+   return n;
+}
+
+static void gen(fuzz_case_t *c)
+{
+   static const char ints[] = "diuxc", lls[] = "diux";
+   char  *p = c->fmt;
+   char  conv;
+   int   kind = rnd() % 8;
+
+   p += add_text(p);
+   *p++ = '%';
+
+   c->type    = kind < 5 ? ARG_INT : kind < 7 ? ARG_LL : ARG_STR;
+   c->nr_star = 0;
+   c->val     = ((uint64_t)rnd() << 32 | rnd()) >> (rnd() % 64);
+   c->str     = strs[rnd() % (sizeof(strs)/sizeof(strs[0]))];
+
+   conv = c->type == ARG_STR ? 's'
+      : c->type == ARG_LL ? lls[rnd() % 4] : ints[rnd() % 5];
+
+   if(rnd() % 3 == 0)
+      *p++ = '-';
+   if(conv != 's' && conv != 'c' && rnd() % 3 == 0)
+      *p++ = '0';
+
+   if(rnd() % 6 == 0)
+   {
+      *p++ = '*';
+      c->star[c->nr_star++] = (int)(rnd() % 41) - 20;
+   }
+   else if(rnd() % 2)
+      p += sprintf(p, "%u", rnd() % 30);
+
+   if(conv != 'c' && rnd() % 2)
+   {
+      *p++ = '.';
+      if(rnd() % 6 == 0)
+      {
+         *p++ = '*';
+         c->star[c->nr_star++] = (int)(rnd() % 41) - 20;
+      }
+      else if(rnd() % 4)
+         p += sprintf(p, "%u", rnd() % 25);
+   }
+
+   if(c->type == ARG_LL)
+      p += sprintf(p, "ll");
+   else if(conv != 'c' && c->type == ARG_INT && rnd() % 4 == 0)
+      p += sprintf(p, rnd() % 2 ? "h" : "hh");
+
+   *p++ = conv;
+
+   if(conv == 'c' && !(c->val & 0xff))
+      c->val |= 'c';
+
+   p += add_text(p);
+   if(rnd() % 8 == 0)
+      p += sprintf(p, "%%%%");
+   *p = 0;
+}
+
+/*
+** Call both formatters with the argument list of the case
+*/
+#define fuzz_call(_fn_,_b_,_l_,_c_,...)                                 \
+   ((_c_)->nr_star == 0 ? _fn_(_b_,_l_,(_c_)->fmt, __VA_ARGS__)         \
+    : (_c_)->nr_star == 1 ? _fn_(_b_,_l_,(_c_)->fmt,                    \
+                                 (_c_)->star[0], __VA_ARGS__)           \
+    : _fn_(_b_,_l_,(_c_)->fmt, (_c_)->star[0], (_c_)->star[1], __VA_ARGS__))
+
+#define fuzz_both(_fn_,_b_,_l_,_c_)                                     \
+   ((_c_)->type == ARG_INT ? fuzz_call(_fn_,_b_,_l_,_c_,(int)(_c_)->val) \
+    : (_c_)->type == ARG_LL ? fuzz_call(_fn_,_b_,_l_,_c_,               \
+                                        (long long)(_c_)->val)          \
+    : fuzz_call(_fn_,_b_,_l_,_c_,(_c_)->str))
+
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+#pragma GCC diagnostic ignored "-Wformat-security"
+
+static int run(fuzz_case_t *c, size_t len)
+{
+   char   kout[OUT_LEN], hout[OUT_LEN];
+   size_t ksz, hsz, i;
+
+   memset(kout, CANARY, sizeof(kout));
+   memset(hout, CANARY, sizeof(hout));
+
+   ksz = fuzz_both(krn_snprintf, kout, len, c);
+   hsz = (size_t)fuzz_both(snprintf, hout, len, c);
+
+   /* kernel returns what it wrote, nul included */
+   if(hsz >= len)
+      hsz = len-1;
+
+   if(ksz != hsz+1 || memcmp(kout, hout, hsz+1))
+      goto bad;
+
+   for(i=len ; i<sizeof(kout) ; i++)
+      if(kout[i] != CANARY)
+         goto bad;
+
+   return 1;
+
+bad:
+   fprintf(stderr, "fuzz: \"%s\" len %zu star %d/%d/%d val 0x%llx\n"
+           "  kernel \"%.*s\" (%zu)\n  host   \"%s\"\n",
+           c->fmt, len, c->nr_star, c->star[0], c->star[1],
+           (unsigned long long)c->val, (int)(ksz ? ksz-1 : 0), kout,
+           ksz, hout);
+   return 0;
+}
+
+unsigned long fuzz_print(unsigned long runs, unsigned long seed)
+{
+   fuzz_case_t   c;
+   unsigned long i, bad = 0;
+
+   rnd_state = seed * 0x9e3779b97f4a7c15ULL + 1;
+
+   for(i=0 ; i<runs && bad<10 ; i++)
+   {
+      gen(&c);
+
+      if(!run(&c, OUT_LEN - 8))
+         bad++;
+      else if(!run(&c, 1 + rnd() % 24))
+         bad++;
+   }
+
+   return bad;
+}
@@ -0,0 +1,10 @@
+/* GPLv2 (c) Airbus */
+#include "ksym_fixture.h"
+
+/*
+** Built as an i386 object, its symbol table
+** is turned into ksym_table.s by ksymgen.py
+*/
+#define ksym_fixture_fn(_n_)     void _n_(void) {}
+
+KSYM_FIXTURE(ksym_fixture_fn)
@@ -0,0 +1,23 @@
+/* GPLv2 (c) Airbus */
+#ifndef __KSYM_FIXTURE_H__
+#define __KSYM_FIXTURE_H__
+
+/*
+** Functions of ksym_fixture.c, in address order: shared
+** prefixes, more than one KSYM_BLOCK, names of KSYM_NAME_MAX-1
+** and KSYM_NAME_MAX characters and one longer than KSYM_NAME_MAX,
+** followed by more names of the same block
+*/
+#define KSYM_FIXTURE(_f_)                                               \
+   _f_(vm_init)  _f_(vm_clone)  _f_(vm_map)  _f_(vm_unmap)              \
+   _f_(vm_flush) _f_(vm_find)   _f_(vm_fault) _f_(vm_fault_cow)         \
+   _f_(vm_fault_zero) _f_(vm_stats) _f_(pmem_init) _f_(pmem_alloc)      \
+   _f_(pmem_alloc_zero) _f_(pmem_alloc_contig) _f_(pmem_get)            \
+   _f_(pmem_put) _f_(pmem_refs) _f_(pmem_refill) _f_(pmem_stats)        \
+   _f_(page_clear) _f_(page_copy) _f_(a)                                \
+   _f_(a_function_name_of_exactly_sixty_three_characters_in_the_tables) \
+   _f_(a_function_name_of_exactly_sixty_four_characters_in_the_table_ab) \
+   _f_(a_function_name_that_does_not_fit_in_the_sixty_four_bytes_buffer) \
+   _f_(a_function_name_that_does_not_fit_either)
+
+#endif
@@ -0,0 +1,121 @@
+/* GPLv2 (c) Airbus */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include "test.h"
+
+#define FUZZ_RUNS   200000UL
+
+typedef struct unit_test
+{
+   const char  *name;
+   void        (*run)();
+
+} unit_test_t;
+
+static unit_test_t tests[] = {
+   {"print",  test_print},
+   {"string", test_string},
+   {"mem",    test_mem},
+   {"ksym",   test_ksym},
+};
+
+#define NR_TESTS    (sizeof(tests)/sizeof(tests[0]))
+
+unsigned long test_checks;
+static unsigned long test_failures;
+
+void test_fail(const char *file, int line, const char *expr)
+{
+   fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expr);
+   test_failures++;
+}
+
+/*
+** Kernel print.c back-end
+*/
+size_t __vsnprintf(char*, size_t, const char*, va_list);
+
+size_t log_vprintf(uint32_t level, const char *format, va_list params)
+{
+   char   msg[512];
+   size_t len;
+
+   (void)level;
+   len = __vsnprintf(msg, sizeof(msg), format, params);
+   fputs(msg, stdout);
+   return len;
+}
+
+void log_sync()      { fflush(stdout); }
+void console_sync()  {}
+void console_flush() { fflush(stdout); }
+void stack_trace(unsigned long from) { (void)from; }
+
+static int run_tests()
+{
+   unsigned long i, checks, failures;
+
+   for(i=0 ; i<NR_TESTS ; i++)
+   {
+      checks   = test_checks;
+      failures = test_failures;
+
+      tests[i].run();
+
+      printf("%-8s %s (%lu checks)\n", tests[i].name,
+             test_failures == failures ? "ok" : "FAIL",
+             test_checks - checks);
+   }
+
+   return test_failures != 0;
+}
+
+static int run_fuzz(unsigned long runs, unsigned long seed)
+{
+   unsigned long bad = fuzz_print(runs, seed);
+
+   printf("fuzz     %s (%lu formats, seed %lu)\n",
+          bad ? "FAIL" : "ok", runs, seed);
+
+   return bad != 0;
+}
+
+static void usage(const char *prog)
+{
+   fprintf(stderr, "usage: %s [test | fuzz [runs [seed]] | bench]\n", prog);
+   exit(2);
+}
+
+int main(int argc, char **argv)
+{
+   unsigned long runs = FUZZ_RUNS, seed = 1;
+
+   if(argc < 2)
+      return run_tests() | run_fuzz(runs, seed);
+
+   if(!strcmp(argv[1], "test"))
+      return run_tests();
+
+   if(!strcmp(argv[1], "fuzz"))
+   {
+      if(argc > 2)
+         runs = strtoul(argv[2], 0, 0);
+      if(argc > 3)
+         seed = strtoul(argv[3], 0, 0);
+
+      return run_fuzz(runs, seed);
+   }
+
+   if(!strcmp(argv[1], "bench"))
+   {
+      bench_string();
+      bench_format();
+      return 0;
+   }
+
+   usage(argv[0]);
+   return 2;
+}
@@ -0,0 +1,44 @@
+/* GPLv2 (c) Airbus */
+#ifndef __TEST_H__
+#define __TEST_H__
+
+/*
+** Host test runner interface
+**
+** Shared by the units built against the kernel headers
+** and the ones built against the host libc: keep it free
+** of any type definition.
+*/
+void           test_fail(const char*, int, const char*);
+extern unsigned long test_checks;
+
+#define check(_c_)                                      \
+   ({                                                   \
+      test_checks++;                                    \
+      if(!(_c_))                                        \
+         test_fail(__FILE__, __LINE__, #_c_);           \
+   })
+
+/*
+** Unit tests (kernel headers)
+*/
+void     test_print();
+void     test_string();
+void     test_mem();
+void     test_ksym();
+
+/*
+** Kernel string.h out of line, for the hosted benchmarks
+*/
+void*    kstring_memcpy(void*, void*, unsigned long);
+void*    kstring_memset(void*, unsigned char, unsigned long);
+int      kstring_erms(int);
+
+/*
+** Fuzzer and benchmarks (host libc)
+*/
+unsigned long fuzz_print(unsigned long, unsigned long);
+void     bench_string();
+void     bench_format();
+
+#endif
@@ -0,0 +1,76 @@
+/* GPLv2 (c) Airbus */
+#include <ksym.h>
+#include <string.h>
+#include "test.h"
+#include "ksym_fixture.h"
+
+#define ksym_fixture_name(_n_)   #_n_,
+
+static const char *names[] = { KSYM_FIXTURE(ksym_fixture_name) };
+
+#define NR_NAMES    ((int)(sizeof(names)/sizeof(names[0])))
+
+/*
+** ksymgen.py keeps KSYM_NAME_MAX-1 characters
+*/
+static int name_is(const char *name, const char *exp)
+{
+   size_t len = strlen((char*)exp);
+
+   if(len > KSYM_NAME_MAX-1)
+      len = KSYM_NAME_MAX-1;
+
+   return strlen((char*)name) == len && !strncmp(name, exp, len);
+}
+
+static void test_ksym_names()
+{
+   char name[KSYM_NAME_MAX];
+   int  i, ok = 1;
+
+   for(i=0 ; i<NR_NAMES ; i++)
+   {
+      ksym_name(i, name, sizeof(name));
+      ok &= name_is(name, names[i]);
+   }
+   check(ok);
+
+   /* unnamed end of section */
+   check(ksym_name(NR_NAMES, name, sizeof(name)) == 0);
+
+   check(ksym_name(7, name, 4) == 12 && name_is(name, "vm_"));
+   check(ksym_name(7, name, 0) == 12);
+
+   /* names of KSYM_NAME_MAX-1 and KSYM_NAME_MAX characters */
+   check(ksym_name(22, name, 0) == KSYM_NAME_MAX-1);
+   check(ksym_name(23, name, 0) == KSYM_NAME_MAX-1);
+}
+
+static void test_ksym_find()
+{
+   char     name[KSYM_NAME_MAX];
+   offset_t off;
+   int      i, ok = 1;
+
+   for(i=0 ; i<NR_NAMES ; i++)
+   {
+      offset_t start = ksym_addr(i), end = ksym_addr(i+1);
+
+      ok &= start < end;
+      ok &= ksym_find(start) == i;
+      ok &= ksym_find(end - 1) == i;
+   }
+   check(ok);
+
+   check(ksym_find(ksym_addr(NR_NAMES)) == -1);
+   check(ksym_find(ksym_addr(NR_NAMES) + 0x1000) == -1);
+
+   check(!ksym_lookup(ksym_addr(8) + 3, name, sizeof(name), &off));
+   check(off == 3 && name_is(name, "vm_fault_zero"));
+}
+
+void test_ksym()
+{
+   test_ksym_names();
+   test_ksym_find();
+}
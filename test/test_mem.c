@@ -0,0 +1,86 @@
+/* GPLv2 (c) Airbus */
+#include <types.h>
+#include <pagemem.h>
+#include <segmem.h>
+#include "test.h"
+
+static void test_mem_page()
+{
+   pde32_t pde;
+   pte32_t pte;
+
+   check(sizeof(pde32_t) == 4 && sizeof(pte32_t) == 4);
+
+   check(pd32_get_idx(0xc0000000UL) == 0x300);
+   check(pd32_get_idx(0xbff00000UL) == 0x2ff);
+   check(pt32_get_idx(0xbff00000UL) == 0x300);
+   check(pt32_get_idx(0x00704123UL) == 0x304);
+
+   check(page_align(0x1fffUL) == 0x1000);
+   check(page_align_next(0x1001UL) == 0x2000);
+   check(page_is_aligned(0x3000UL) && !page_is_aligned(0x3004UL));
+   check(pg_4K_get_offset(0x1234UL) == 0x234);
+   check(page_get_nr(0x12345000UL) == 0x12345);
+   check(page_get_addr(0x12345) == 0x12345000UL);
+   check(pg_4M_align(0x00bfffffUL) == 0x00800000UL);
+   check(pg_4M_get_nr(0xc0400000UL) == 0x301);
+
+   pg_set_entry(&pte, PG_USR|PG_RW, 0x12345);
+   check(pte.raw == 0x12345007);
+   check(pg_present(&pte) && pg_writable(&pte) && pte.lvl);
+
+   pg_set_entry(&pte, PG_USR|PG_RO, 0x1);
+   check(!pg_writable(&pte));
+
+   pg_set_zero(&pte);
+   check(!pg_present(&pte) && !pg_readable(&pte));
+
+   pg_set_large_entry(&pde, PG_KRN|PG_RW, 0x300);
+   check(pde.raw == 0xc0000083);
+   check(pg_large(&pde));
+}
+
+static void test_mem_seg()
+{
+   seg_desc_t dsc;
+   seg_sel_t  sel;
+
+   check(sizeof(seg_desc_t) == 8 && sizeof(seg_sel_t) == 2);
+   check(sizeof(tss_stack_t) == 8);
+
+   check(gdt_krn_seg_sel(1) == 0x08);
+   check(gdt_usr_seg_sel(3) == 0x1b);
+   check(ldt_seg_sel(2,SEG_SEL_USR) == 0x17);
+
+   sel.raw = gdt_usr_seg_sel(4);
+   check(sel.index == 4 && sel.rpl == SEG_SEL_USR && sel.ti == SEG_SEL_GDT);
+
+   /* flat ring 0 code segment */
+   dsc.raw     = 0;
+   dsc.limit_1 = 0xffff;
+   dsc.limit_2 = 0xf;
+   dsc.type    = SEG_DESC_CODE_XR;
+   dsc.s       = 1;
+   dsc.dpl     = SEG_SEL_KRN;
+   dsc.p       = 1;
+   dsc.d       = 1;
+   dsc.g       = 1;
+   check(dsc.raw == 0x00cf9a000000ffffULL);
+
+   /* ring 3 data segment based at 0x12345678 */
+   dsc.raw     = 0;
+   dsc.base_1  = 0x5678;
+   dsc.base_2  = 0x34;
+   dsc.base_3  = 0x12;
+   dsc.type    = SEG_DESC_DATA_RW;
+   dsc.s       = 1;
+   dsc.dpl     = SEG_SEL_USR;
+   dsc.p       = 1;
+   check(dsc.raw == 0x1200f23456780000ULL);
+}
+
+void test_mem()
+{
+   test_mem_page();
+   test_mem_seg();
+}
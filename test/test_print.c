@@ -0,0 +1,115 @@
+/* GPLv2 (c) Airbus */
+#include <print.h>
+#include <string.h>
+#include "test.h"
+
+static char out[128];
+
+static int streq(const char *a, const char *b)
+{
+   while(*a && *a == *b)
+   {
+      a++;
+      b++;
+   }
+
+   return *a == *b;
+}
+
+/*
+** Format into out[len] and check the text and the
+** returned size (terminating nul included)
+*/
+static int fmt_is(size_t len, const char *exp, const char *format, ...)
+{
+   va_list params;
+   size_t  sz;
+
+   va_start(params, format);
+   sz = __vsnprintf(out, len, format, params);
+   va_end(params);
+
+   return streq(out, exp) && sz == strlen((char*)exp)+1;
+}
+
+#define fmt(_e_,_f_,...)   check(fmt_is(sizeof(out),_e_,_f_, ## __VA_ARGS__))
+
+static void test_print_int()
+{
+   fmt("0",                    "%d", 0);
+   fmt("-1",                   "%d", -1);
+   fmt("2147483647",           "%d", 0x7fffffff);
+   fmt("-2147483648",          "%d", (sint32_t)0x80000000);
+   fmt("4294967295",           "%u", 0xffffffffU);
+   fmt("-32768 65535 -1 255",  "%hd %hu %hhd %hhu", 0x18000, 0xffff, 0xff, 0x1ff);
+   fmt("4294967295",           "%lu", 0xffffffffUL);
+   fmt("18446744073709551615", "%llu", 0xffffffffffffffffULL);
+   fmt("-9223372036854775808", "%lld", (sint64_t)0x8000000000000000ULL);
+   fmt("1000000000000000000",  "%llu", 1000000000000000000ULL);
+   fmt("4294967296",           "%llu", 0x100000000ULL);
+   fmt("-42",                  "%D", (sint64_t)-42);
+}
+
+static void test_print_hex()
+{
+   fmt("0 deadbeef",           "%x %x", 0, 0xdeadbeef);
+   fmt("123456789abcdef0",     "%llx", 0x123456789abcdef0ULL);
+   fmt("ffffffffffffffff",     "%X", 0xffffffffffffffffULL);
+   fmt("0xc0000000",           "%p", (void*)0xc0000000UL);
+   fmt("00000000000000000000000000000101", "%b", 5);
+   fmt("0000000000000000000000000000000000000000000000000000000000000011",
+       "%B", 3ULL);
+}
+
+static void test_print_spec()
+{
+   fmt("00001234",             "%08x", 0x1234);
+   fmt("    1234",             "%8x", 0x1234);
+   fmt("1234    |",            "%-8x|", 0x1234);
+   fmt("ab        |",          "%-10s|", "ab");
+   fmt("        ab",           "%10s", "ab");
+   fmt("abc",                  "%.3s", "abcdef");
+   fmt("  -0042",              "%7.4d", -42);
+   fmt("-0042",                "%05d", -42);
+   fmt("-42  |",               "%-05d|", -42);
+   fmt("  007",                "%05.3d", 7);
+   fmt("",                     "%.0d", 0);
+   fmt("   x",                 "%4c", 'x');
+   fmt("  -7|-7  |",           "%*d|%*d|", 4, -7, -4, -7);
+   fmt("ab",                   "%.*s", 2, "abc");
+   fmt("abc",                  "%.*s", -1, "abc");
+   fmt("  0x1f",               "%6p", (void*)0x1fUL);
+   fmt("(null)",               "%s", (char*)0);
+   fmt("100%",                 "%d%%", 100);
+}
+
+static void test_print_trunc()
+{
+   out[7] = 'X';
+   out[8] = 'Y';
+
+   check(fmt_is(8, "hello w", "hello world"));
+   check(out[7] == 0 && out[8] == 'Y');
+   check(fmt_is(8, "ab     ", "%-10s|", "ab"));
+   check(fmt_is(8, "4294967", "%u", 0xffffffffU));
+   check(fmt_is(1, "", "abc"));
+   check(fmt_is(2, "-", "%d", -5));
+}
+
+static void test_print_snprintf()
+{
+   char   buf[16];
+   size_t sz;
+
+   sz = snprintf(buf, sizeof(buf), "%s:%04x", "cs", 0x8);
+   check(sz == 8 && streq(buf, "cs:0008"));
+}
+
+void test_print()
+{
+   test_print_int();
+   test_print_hex();
+   test_print_spec();
+   test_print_trunc();
+   test_print_snprintf();
+}
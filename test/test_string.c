@@ -0,0 +1,261 @@
+/* GPLv2 (c) Airbus */
+#include <types.h>
+#include <string.h>
+#include <pagemem.h>
+#include <info.h>
+#include "test.h"
+
+#define BUF_LEN     1024
+#define GUARD       16
+
+/*
+** string_init() reads the features from info->cpu
+*/
+static info_t __info;
+       info_t *info = &__info;
+
+static uint8_t src[BUF_LEN+2*GUARD];
+static uint8_t dst[BUF_LEN+2*GUARD];
+
+static void fill(uint8_t *b, size_t n, uint8_t seed)
+{
+   size_t i;
+
+   for(i=0 ; i<n ; i++)
+      b[i] = (uint8_t)(seed + i*7);
+}
+
+/*
+** Every size around the dword/byte split, every
+** source/destination misalignment, guards untouched
+*/
+static void test_string_memcpy()
+{
+   size_t  sz, so, dof, i;
+   int     ok;
+
+   for(sz=0 ; sz<=160 ; sz++)
+      for(so=0 ; so<4 ; so++)
+         for(dof=0 ; dof<4 ; dof++)
+         {
+            fill(src, sizeof(src), (uint8_t)sz);
+            memset(dst, 0xa5, sizeof(dst));
+
+            check(memcpy(&dst[GUARD+dof], &src[GUARD+so], sz)
+                  == &dst[GUARD+dof]);
+
+            ok = 1;
+            for(i=0 ; i<sizeof(dst) ; i++)
+               if(i >= GUARD+dof && i < GUARD+dof+sz)
+                  ok &= dst[i] == src[GUARD+so+i-GUARD-dof];
+               else
+                  ok &= dst[i] == 0xa5;
+
+            check(ok);
+         }
+
+   fill(src, sizeof(src), 3);
+   memcpy(&dst[GUARD+1], &src[GUARD], BUF_LEN-1);
+   check(dst[GUARD+BUF_LEN-1] == src[GUARD+BUF_LEN-2]);
+}
+
+static void test_string_memset()
+{
+   size_t  sz, dof, i;
+   int     ok;
+
+   for(sz=0 ; sz<=160 ; sz++)
+      for(dof=0 ; dof<4 ; dof++)
+      {
+         for(i=0 ; i<sizeof(dst) ; i++)
+            dst[i] = 0x5a;
+
+         check(memset(&dst[GUARD+dof], 0xc3, sz) == &dst[GUARD+dof]);
+
+         ok = 1;
+         for(i=0 ; i<sizeof(dst) ; i++)
+            if(i >= GUARD+dof && i < GUARD+dof+sz)
+               ok &= dst[i] == 0xc3;
+            else
+               ok &= dst[i] == 0x5a;
+
+         check(ok);
+      }
+}
+
+/*
+** Constant sizes take the inline path
+*/
+#define check_const(_n_)                                        \
+   ({                                                           \
+      fill(src, sizeof(src), _n_);                              \
+      memset(dst, 0, sizeof(dst));                              \
+      memcpy(&dst[GUARD+1], &src[GUARD+3], _n_);                \
+      check(!differ(&dst[GUARD+1], &src[GUARD+3], _n_)  \
+            && !dst[GUARD] && !dst[GUARD+1+_n_]);               \
+      memset(&dst[GUARD+2], 0x77, _n_);                         \
+      check(dst[GUARD+1] != 0x77 && dst[GUARD+2+_n_] != 0x77    \
+            && dst[GUARD+1+_n_] == 0x77);                       \
+   })
+
+static int differ(uint8_t *a, uint8_t *b, size_t n)
+{
+   while(n--)
+      if(*a++ != *b++)
+         return 1;
+
+   return 0;
+}
+
+static void test_string_const()
+{
+   check_const(1);
+   check_const(2);
+   check_const(3);
+   check_const(4);
+   check_const(7);
+   check_const(12);
+   check_const(15);
+   check_const(32);
+}
+
+/*
+** Both directions of overlap, every distance and size
+*/
+static void test_string_memmove()
+{
+   size_t sz, dist, i;
+   int    ok;
+
+   for(sz=0 ; sz<=80 ; sz++)
+      for(dist=0 ; dist<=9 ; dist++)
+      {
+         fill(src, sizeof(src), (uint8_t)sz);
+         fill(dst, sizeof(dst), (uint8_t)sz);
+         memmove(&dst[GUARD+dist], &dst[GUARD], sz);
+
+         ok = 1;
+         for(i=0 ; i<sz ; i++)
+            ok &= dst[GUARD+dist+i] == src[GUARD+i];
+         ok &= dst[GUARD+dist+sz] == src[GUARD+dist+sz];
+         check(ok);
+
+         fill(dst, sizeof(dst), (uint8_t)sz);
+         memmove(&dst[GUARD], &dst[GUARD+dist], sz);
+
+         ok = 1;
+         for(i=0 ; i<sz ; i++)
+            ok &= dst[GUARD+i] == src[GUARD+dist+i];
+         check(ok);
+      }
+}
+
+static void test_string_cmp()
+{
+   size_t sz, i;
+
+   for(sz=1 ; sz<=40 ; sz++)
+   {
+      fill(src, sz, 9);
+      fill(dst, sz, 9);
+      check(memcmp(src, dst, sz) == 0);
+
+      for(i=0 ; i<sz ; i++)
+      {
+         dst[i]++;
+         check(memcmp(src, dst, sz) < 0 && memcmp(dst, src, sz) > 0);
+         check(memcmp(src, dst, i) == 0);
+         dst[i]--;
+      }
+   }
+
+   check(memcmp("\x80", "\x01", 1) > 0);
+
+   check(strncmp("secos", "secos", 10) == 0);
+   check(strncmp("secos", "secosng", 5) == 0);
+   check(strncmp("secos", "secosng", 6) < 0);
+   check(strncmp("uart", "debugcon", 4) > 0);
+   check(strncmp("a", "b", 0) == 0);
+   check(strncmp("\xff", "a", 1) > 0);
+}
+
+static void test_string_str()
+{
+   char s[] = "secos-ng kernel";
+
+   check(strlen("") == 0);
+   check(strlen(s) == 15);
+   check(strchr(s, sizeof(s), '-') == &s[5]);
+   check(strchr(s, sizeof(s), 'k') == &s[9]);
+   check(strchr(s, 5, 'n') == 0);
+}
+
+static void test_string_page()
+{
+   static uint32_t a[PAGE_SIZE/sizeof(uint32_t)] __attribute__((aligned(16)));
+   static uint32_t b[PAGE_SIZE/sizeof(uint32_t)] __attribute__((aligned(16)));
+   size_t i;
+   int    ok = 1;
+
+   fill((uint8_t*)a, sizeof(a), 1);
+   __copy_page(b, a);
+   for(i=0 ; i<PAGE_SIZE/sizeof(uint32_t) ; i++)
+      ok &= a[i] == b[i];
+   check(ok);
+
+   __clear_page(b);
+   for(i=0 ; i<PAGE_SIZE/sizeof(uint32_t) ; i++)
+      ok &= !b[i];
+   check(ok);
+
+   /* sse2 is baseline on the host, no fpu section needed */
+   __copy_page_nt(b, a);
+   for(i=0 ; i<PAGE_SIZE/sizeof(uint32_t) ; i++)
+      ok &= a[i] == b[i];
+   check(ok);
+
+   __clear_page_nt(b);
+   for(i=0 ; i<PAGE_SIZE/sizeof(uint32_t) ; i++)
+      ok &= !b[i];
+   check(ok);
+}
+
+void* kstring_memcpy(void *dst, void *src, unsigned long size)
+{
+   return memcpy(dst, src, size);
+}
+
+void* kstring_memset(void *dst, unsigned char c, unsigned long size)
+{
+   return memset(dst, c, size);
+}
+
+int kstring_erms(int on)
+{
+   bool_t erms = string_erms;
+
+   string_erms = on ? true : false;
+   return erms;
+}
+
+static void test_string_all()
+{
+   test_string_memcpy();
+   test_string_memset();
+   test_string_const();
+   test_string_memmove();
+   test_string_cmp();
+   test_string_str();
+   test_string_page();
+}
+
+void test_string()
+{
+   bool_t erms = string_erms;
+
+   string_erms = false;
+   test_string_all();
+   string_erms = true;
+   test_string_all();
+   string_erms = erms;
+}
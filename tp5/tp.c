@@ -4,7 +4,7 @@
 
 void syscall_isr() {
    asm volatile (
-      "leave ; pusha        \n"
+      "leave ; pusha ; cld  \n"
       "mov %esp, %eax      \n"
       "call syscall_handler \n"
       "popa ; iret"
@@ -0,0 +1,746 @@
+/**
+ * @file bench.c
+ * @brief Micro-benchmarks exécutés au démarrage (make BENCH=1)
+ *
+ * Chaque mesure est faite en cycles (rdtsc), interruptions masquées,
+ * avant le passage en mode utilisateur.
+ */
+#ifdef CONFIG_BENCH
+#include <debug.h>
+#include <pagemem.h>
+#include <pmem.h>
+#include <vm.h>
+#include <ipc.h>
+#include <bench.h>
+#include <uart.h>
+#include <debugcon.h>
+#include <vdso.h>
+#include <log.h>
+#include <string.h>
+
+/**
+@def BENCH_RUNS
+@brief Nombre de mesures par configuration
+*/
+#define BENCH_RUNS      64
+
+/**
+@def BENCH_IPC_SND
+@brief Tampon d'émission dans l'espace A (et de réception du retour)
+*/
+#define BENCH_IPC_SND   0x10000000UL
+
+/**
+@def BENCH_IPC_RCV
+@brief Adresse de réception par transfert de pages dans l'espace B
+*/
+#define BENCH_IPC_RCV   0x20000000UL
+
+/**
+@def BENCH_IPC_CPY
+@brief Tampon de réception par copie dans l'espace B
+*/
+#define BENCH_IPC_CPY   0x30000000UL
+
+/**
+@var bench_vm_a
+@brief Espace d'adressage émetteur
+*/
+static vm_t bench_vm_a;
+
+/**
+@var bench_vm_b
+@brief Espace d'adressage récepteur
+*/
+static vm_t bench_vm_b;
+
+/**
+ * @fn static void bench_map(vm_t *vm, offset_t va, size_t nr)
+ * @brief Projette nr pages à zéro en va
+ */
+static void bench_map(vm_t *vm, offset_t va, size_t nr){
+
+	size_t i;
+
+	for (i = 0; i < nr; i++) {
+		offset_t pa = pmem_alloc_zero();
+
+		if (!pa || vm_map(vm, va + i*PAGE_SIZE, pa, PG_USR|PG_RW) < 0)
+			panic("bench: mémoire insuffisante\n");
+	}
+}
+
+/**
+ * @fn static void bench_ipc()
+ * @brief Compare l'envoi par transfert de pages et l'envoi par copie
+ *
+ * Pour chaque taille, la mesure couvre ipc_send() dans A suivi de
+ * ipc_recv() dans B. Le retour des pages de B vers A n'est pas mesuré.
+ */
+static void bench_ipc(){
+
+	ipc_chan_t *ch = &ipc_chans[0];
+	size_t     sizes[] = {1, 4, 16, IPC_MAX_PAGES};
+	size_t     s, i, len, rlen;
+	bench_t    remap, copy;
+	uint64_t   t, t2;
+
+	vm_init(&bench_vm_a);
+	vm_init(&bench_vm_b);
+	bench_map(&bench_vm_a, BENCH_IPC_SND, IPC_MAX_PAGES);
+	bench_map(&bench_vm_b, BENCH_IPC_CPY, IPC_MAX_PAGES);
+
+	for (s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++) {
+		len = sizes[s]*PAGE_SIZE;
+		bench_init(&remap);
+		bench_init(&copy);
+
+		for (i = 0; i < BENCH_RUNS; i++) {
+			vm_switch(&bench_vm_a);
+			*(volatile uint32_t*)BENCH_IPC_SND = i;
+
+			t = rdtsc();
+			if (ipc_send(ch, &bench_vm_a, BENCH_IPC_SND, len, 0) < 0)
+				panic("bench: ipc_send\n");
+			t = rdtsc() - t;
+
+			vm_switch(&bench_vm_b);
+			t2 = rdtsc();
+			if (ipc_recv(ch, &bench_vm_b, BENCH_IPC_RCV, &rlen) != BENCH_IPC_RCV)
+				panic("bench: ipc_recv\n");
+			bench_add(&remap, t + rdtsc() - t2);
+
+			if (*(volatile uint32_t*)BENCH_IPC_RCV != i || rlen != len)
+				panic("bench: message corrompu\n");
+
+			if (ipc_send(ch, &bench_vm_b, BENCH_IPC_RCV, len, 0) < 0)
+				panic("bench: ipc_send retour\n");
+
+			vm_switch(&bench_vm_a);
+			if (ipc_recv(ch, &bench_vm_a, BENCH_IPC_SND, &rlen) != BENCH_IPC_SND)
+				panic("bench: ipc_recv retour\n");
+
+			t = rdtsc();
+			if (ipc_send(ch, &bench_vm_a, BENCH_IPC_SND, len, IPC_COPY) < 0)
+				panic("bench: ipc_send copie\n");
+			t = rdtsc() - t;
+
+			vm_switch(&bench_vm_b);
+			t2 = rdtsc();
+			if (ipc_recv(ch, &bench_vm_b, BENCH_IPC_CPY, &rlen) != BENCH_IPC_CPY)
+				panic("bench: ipc_recv copie\n");
+			bench_add(&copy, t + rdtsc() - t2);
+
+			if (*(volatile uint32_t*)BENCH_IPC_CPY != i)
+				panic("bench: copie corrompue\n");
+		}
+
+		debug("ipc %lu pages\n", sizes[s]);
+		bench_print("  remap", &remap);
+		bench_print("  copy ", &copy);
+	}
+}
+
+/**
+@def BENCH_UART_BYTES
+@brief Volume écrit sur le port série par mesure
+*/
+#define BENCH_UART_BYTES  4096
+
+/**
+@def BENCH_UART_LINE
+@brief Longueur d'une ligne de remplissage (retour à la ligne compris)
+*/
+#define BENCH_UART_LINE   64
+
+/**
+@typedef bench_write_t
+@brief Fonction d'écriture d'un moteur de console
+*/
+typedef size_t (*bench_write_t)(uint8_t*, size_t);
+
+/**
+ * @fn static void bench_console_one(char *name, bench_write_t write, char c)
+ * @brief Écrit BENCH_UART_BYTES octets par lignes de BENCH_UART_LINE
+ *
+ * Le débit est calculé à partir de la fréquence du TSC étalonnée par vdso.
+ */
+static void bench_console_one(char *name, bench_write_t write, char c){
+
+	static uint8_t line[BENCH_UART_LINE];
+	uint64_t t, d, cyc, rate;
+	size_t   i;
+
+	for (i = 0; i < BENCH_UART_LINE-1; i++)
+		line[i] = c;
+	line[i] = '\n';
+
+	t = rdtsc();
+	for (i = 0; i < BENCH_UART_BYTES/BENCH_UART_LINE; i++)
+		write(line, BENCH_UART_LINE);
+	t = rdtsc() - t;
+
+	cyc = t;
+	div64(&cyc, BENCH_UART_BYTES);
+
+	// diviseur ramené à 32 bits pour div64
+	rate = (uint64_t)BENCH_UART_BYTES*vdso->tsc_khz*1000;
+	for (d = t; d >> 32; d >>= 1)
+		rate >>= 1;
+	if (d)
+		div64(&rate, (uint32_t)d);
+	else
+		rate = 0;
+
+	debug("bench console %s: %u bytes, %llu cycles/byte, %llu bytes/s\n",
+	      name, BENCH_UART_BYTES, cyc, rate);
+}
+
+/**
+ * @fn static void bench_console()
+ * @brief Compare l'UART octet par octet, par rafales de UART_FIFO_LEN,
+ * et le port de débogage de QEMU quand il est présent
+ */
+static void bench_console(){
+
+	uart_set_fifo(false);
+	bench_console_one("uart no fifo", uart_write, '-');
+	uart_set_fifo(true);
+	bench_console_one("uart fifo   ", uart_write, '=');
+
+	if (debugcon_present())
+		bench_console_one("debugcon    ", debugcon_write, '~');
+}
+
+/**
+@def BENCH_LOG_RUNS
+@brief Nombre de messages par mesure (l'anneau du journal ne doit pas déborder)
+*/
+#define BENCH_LOG_RUNS    (LOG_NR_RECORDS/2)
+
+/**
+ * @fn static void bench_log()
+ * @brief Coût d'un message formaté (log_printf) et d'un message binaire (log_fast)
+ *
+ * Journal différé et filtré pendant la mesure : seul l'enregistrement
+ * est compté, les messages sont écartés au vidage.
+ */
+static void bench_log(){
+
+	uint32_t level = log_level;
+	bench_t  text, fast;
+	uint64_t t;
+	uint32_t i;
+
+	bench_init(&text);
+	bench_init(&fast);
+	log_level = LOG_ERR;
+	log_defer(true);
+
+	for (i = 0; i < BENCH_LOG_RUNS; i++) {
+		t = rdtsc();
+		log_printf(LOG_INFO, "bench %u: %u pages, 0x%x\n", i, PMEM_NR_FRAMES, i);
+		bench_add(&text, rdtsc() - t);
+	}
+
+	for (i = 0; i < BENCH_LOG_RUNS; i++) {
+		t = rdtsc();
+		log_fast("bench %u: %u pages, 0x%x\n", i, PMEM_NR_FRAMES, i);
+		bench_add(&fast, rdtsc() - t);
+	}
+
+	log_defer(false);
+	log_level = level;
+
+	bench_print("log_printf", &text);
+	bench_print("log_fast  ", &fast);
+}
+
+/**
+@def BENCH_FMT_RUNS
+@brief Nombre de formatages par mesure
+*/
+#define BENCH_FMT_RUNS    256
+
+/*
+** Copie du formateur d'origine (__vsnprintf avant sa réécriture),
+** référence de bench_format() : ajout octet par octet, conversions
+** décimales par divisions 64 bits de libgcc (__udivdi3, __divdi3)
+*/
+static inline void __old_format_add_str(buffer_t *buf, size_t len, char *s)
+{
+   while(*s)
+      __buf_add(buf, len, *s++);
+}
+
+static inline void __old_format_add_chr(buffer_t *buf, size_t len, int c)
+{
+   __buf_add(buf, len, (char)c);
+}
+
+static inline void __old_format_add_bin(buffer_t *buf, size_t len,
+                                        uint64_t value, uint32_t n)
+{
+   uint32_t i, bit;
+
+   for(i=0 ; i<n ; i++)
+   {
+      bit = (value >> (n-i-1)) & 1;
+      __buf_add(buf, len, bit?'1':'0');
+   }
+}
+
+static inline void __old_format_add_idec(buffer_t *buf, size_t len, sint64_t value)
+{
+   char     rep[24];
+   buffer_t dec;
+
+   if(!value)
+      return __buf_add(buf, len, '0');
+
+   dec.data.str = rep;
+   dec.sz = 0;
+
+   if(value < 0)
+   {
+      __buf_add(buf, len, '-');
+      value = -value;
+   }
+
+   while(value)
+   {
+      dec.data.str[dec.sz++] = (value%10) + '0';
+      value /= 10;
+   }
+
+   while(dec.sz--)
+      __buf_add(buf, len, dec.data.str[dec.sz]);
+}
+
+static inline void __old_format_add_udec(buffer_t *buf, size_t len, uint64_t value)
+{
+   char     rep[24];
+   buffer_t dec;
+
+   if(!value)
+      return __buf_add(buf, len, '0');
+
+   dec.data.str = rep;
+   dec.sz = 0;
+
+   while(value)
+   {
+      dec.data.str[dec.sz++] = (value%10) + '0';
+      value /= 10;
+   }
+
+   while(dec.sz--)
+      __buf_add(buf, len, dec.data.str[dec.sz]);
+}
+
+static char __old_hextable[] = {'0','1','2','3','4','5','6','7',
+                                '8','9','a','b','c','d','e','f'};
+
+static inline void __old_format_add_hex(buffer_t *buf, size_t len,
+                                        uint64_t value, size_t precision)
+{
+   char   rep[sizeof(uint64_t)*2];
+   size_t rsz = 0;
+
+   if(!precision || precision > 16)
+      precision = -1;
+
+   while(precision && !(precision > 16 && !value && rsz))
+   {
+      rep[rsz] = __old_hextable[value & 0xf];
+      value >>= 4;
+      rsz++;
+      precision--;
+   }
+
+   while(rsz--)
+      __buf_add(buf, len, rep[rsz]);
+}
+
+static size_t __old_vsnprintf(char *buffer, size_t len,
+                              const char *format, va_list params)
+{
+   buffer_t buf;
+   size_t   size;
+   char     c;
+   bool_t   interp, lng;
+
+   buf.data.str = buffer;
+   buf.sz = 0;
+   interp = false;
+   lng = false;
+   size = 4;
+
+   if(len) len--;
+
+   while(*format)
+   {
+      c = *format++;
+
+      if(interp)
+      {
+         // length modifiers, may continue to keep 'interp'
+         if(c == 'l'){
+            if(lng)
+               size = 8;
+            else
+               lng = true;
+            continue;
+         } else if(c == 'h'){
+            size /= 2;
+            continue;
+         }
+
+         // conversion modifiers
+         if(c == 's'){
+            char* value = va_arg(params, char*);
+            __old_format_add_str(&buf, len, value);
+         } else if(c == 'c'){
+            int value = va_arg(params, int);
+            __old_format_add_chr(&buf, len, value);
+         } else if(c == 'b'){
+            uint64_t value = va_arg(params, uint32_t);
+            __old_format_add_bin(&buf, len, value, 32);
+         } else if(c == 'B'){
+            uint64_t value = va_arg(params, uint64_t);
+            __old_format_add_bin(&buf, len, value, 64);
+
+            // interpret size length modifier
+         } else if(c == 'd' || c == 'i'){
+            sint64_t value;
+
+            if(size >= 8)
+               value = va_arg(params, sint64_t);
+            else if(size == 4)
+               value = va_arg(params, sint32_t);
+            else if(size == 2)
+               value = (sint16_t)va_arg(params, int);
+            else
+               value = (sint8_t)va_arg(params, int);
+
+            __old_format_add_idec(&buf, len, value);
+
+         } else if(c == 'u' || c == 'x'){
+            uint64_t value;
+
+            if(size >= 8)
+               value = va_arg(params, uint64_t);
+            else if(size == 4)
+               value = va_arg(params, uint32_t);
+            else if(size == 2)
+               value = (uint16_t)va_arg(params, unsigned int);
+            else
+               value = (uint8_t)va_arg(params, unsigned int);
+
+            if(c == 'u')
+               __old_format_add_udec(&buf, len, value);
+            else
+               __old_format_add_hex(&buf, len, value, 0);
+
+            // force size to 64 bits
+         } else if(c == 'D'){
+            sint64_t value = va_arg(params, sint64_t);
+            __old_format_add_idec(&buf, len, value);
+         } else if(c == 'X'){
+            uint64_t value = va_arg(params, uint64_t);
+            __old_format_add_hex(&buf, len, value, 0);
+
+            // '0x'%lx
+         } else if(c == 'p'){
+            uint64_t value = va_arg(params, uint32_t);
+            __old_format_add_str(&buf, len, "0x");
+            __old_format_add_hex(&buf, len, value, 0);
+
+            // ignore padding, precision ...
+         } else if (c >= '0' && c <= '9') {
+            continue;
+
+            // escaped '%'
+         } else if (c == '%') {
+            __buf_add(&buf, len, c);
+
+            // take care of unsupported format used
+         } else {
+            panic("unsupported format arg '%c'\n", c);
+         }
+
+         interp = false;
+         lng = false;
+      }
+      else if(c == '%')
+      {
+         interp = true;
+         size = 4;
+      }
+      else
+         __buf_add(&buf, len, c);
+   }
+
+   buf.data.str[buf.sz++] = 0;
+   return buf.sz;
+}
+
+/**
+ * @fn static size_t bench_old_snprintf(char *buf, size_t len, const char *fmt, ...)
+ * @brief snprintf() d'origine, par __old_vsnprintf
+ */
+static size_t __attribute__ ((__format__(printf, 3, 4)))
+bench_old_snprintf(char *buf, size_t len, const char *fmt, ...){
+
+	va_list params;
+	size_t  ret;
+
+	va_start(params, fmt);
+	ret = __old_vsnprintf(buf, len, fmt, params);
+	va_end(params);
+
+	return ret;
+}
+
+/**
+@def bench_fmt_case
+@brief Mesure le même formatage par l'ancien puis par le nouveau snprintf()
+*/
+#define bench_fmt_case(_n_,_fmt_,...)						\
+	({									\
+		uint64_t _t_ = rdtsc();						\
+		bench_old_snprintf(buf, sizeof(buf), _fmt_, __VA_ARGS__);	\
+		bench_add(&ref[_n_], rdtsc() - _t_);				\
+		_t_ = rdtsc();							\
+		snprintf(buf, sizeof(buf), _fmt_, __VA_ARGS__);			\
+		bench_add(&cur[_n_], rdtsc() - _t_);				\
+	})
+
+/**
+@def BENCH_FMT_CASES
+@brief Nombre de formats mesurés par bench_format()
+*/
+#define BENCH_FMT_CASES   5
+
+/**
+ * @fn static void bench_format()
+ * @brief Coût de snprintf() sur des formats typiques de debug()
+ *
+ * Chaque format est mesuré avec le formateur d'origine (ref) puis
+ * avec l'actuel (new). Les largeurs sont ignorées par l'ancien, et
+ * '-' n'y existe pas : les formats s'en passent.
+ */
+static void bench_format(){
+
+	static char *names[BENCH_FMT_CASES] = {
+		"%u                ",
+		"0x%08x 0x%x       ",
+		"%s %d             ",
+		"%u %llu           ",
+		"vm_stats          ",
+	};
+	static char buf[128];
+	bench_t  ref[BENCH_FMT_CASES], cur[BENCH_FMT_CASES];
+	uint64_t t;
+	uint32_t i, v;
+
+	for (i = 0; i < BENCH_FMT_CASES; i++) {
+		bench_init(&ref[i]);
+		bench_init(&cur[i]);
+	}
+
+	for (i = 0; i < BENCH_FMT_RUNS; i++) {
+		v = (uint32_t)rdtsc() * 2654435761U;
+		t = rdtsc();
+
+		bench_fmt_case(0, "%u", v);
+		bench_fmt_case(1, "cr3 0x%08x pde 0x%x\n", v, v>>22);
+		bench_fmt_case(2, "task %s pid %d\n", "console", (int)i);
+		bench_fmt_case(3, "Valeur compteur: %u (tsc %llu)\n", v, t);
+		bench_fmt_case(4, "%s: %d faults, %llu cycles (avg %llu, max %llu)\n",
+			       "cow", (int)i, t, t >> 8, t >> 4);
+	}
+
+	for (i = 0; i < BENCH_FMT_CASES; i++) {
+		debug("bench fmt %s ref/new\n", names[i]);
+		bench_print("  ref", &ref[i]);
+		bench_print("  new", &cur[i]);
+	}
+}
+
+/**
+@def BENCH_STR_MAX
+@brief Plus grande copie mesurée (de 1 octet à 64 Kio)
+*/
+#define BENCH_STR_MAX     (64*1024)
+
+/**
+@def BENCH_STR_RUNS
+@brief Nombre de mesures par taille
+*/
+#define BENCH_STR_RUNS    16
+
+/**
+@var bench_str_src
+@brief Source des copies
+*/
+static uint8_t bench_str_src[BENCH_STR_MAX+4] __attribute__((aligned(16)));
+
+/**
+@var bench_str_dst
+@brief Destination des copies
+*/
+static uint8_t bench_str_dst[BENCH_STR_MAX+4] __attribute__((aligned(16)));
+
+/**
+ * @fn static void bench_str_ref(void *dst, void *src, size_t size)
+ * @brief Copie de référence : ancienne version (div, pushf/popf autour
+ * de cld, destination non alignée)
+ */
+static void bench_str_ref(void *dst, void *src, size_t size){
+
+	size_t  cnt, rm;
+	ulong_t flags;
+
+	asm volatile ("div %%ecx":"=a"(cnt),"=d"(rm):"a"(size),"d"(0),"c"(4));
+	save_flags(flags);
+	asm volatile ("cld ; rep movsl"
+		      :"+D"(dst),"+S"(src),"+c"(cnt)::"memory");
+	load_flags(flags);
+	save_flags(flags);
+	asm volatile ("cld ; rep movsb"
+		      :"+D"(dst),"+S"(src),"+c"(rm)::"memory");
+	load_flags(flags);
+}
+
+/**
+@def bench_str_one
+@brief Moyenne en cycles de BENCH_STR_RUNS exécutions de _op_
+*/
+#define bench_str_one(_b_,_op_)						\
+	({								\
+		uint32_t _i_;						\
+		bench_init(_b_);					\
+		for (_i_ = 0; _i_ < BENCH_STR_RUNS; _i_++) {		\
+			uint64_t _t_ = rdtsc();				\
+			_op_;						\
+			bench_add(_b_, rdtsc() - _t_);			\
+		}							\
+		bench_avg(_b_);						\
+	})
+
+/**
+ * @fn static void bench_string()
+ * @brief Cycles par appel de memcpy()/memset() de 1 octet à 64 Kio
+ *
+ * Colonnes : ancienne copie, memcpy sans puis avec ERMS, memcpy vers
+ * une destination décalée d'un octet, memset. La taille 8 est aussi
+ * mesurée en constante (chemin en ligne).
+ */
+static void bench_string(){
+
+	bool_t   erms = string_erms;
+	uint8_t  *s = bench_str_src, *d = bench_str_dst;
+	uint64_t ref, cpy, rms, mis, set;
+	bench_t  b;
+	size_t   sz;
+
+	debug("bench string: size ref memcpy erms(%u) memcpy+1 memset\n", erms);
+
+	for (sz = 1; sz <= BENCH_STR_MAX; sz *= 4) {
+		ref = bench_str_one(&b, bench_str_ref(d, s, sz));
+		string_erms = false;
+		cpy = bench_str_one(&b, memcpy(d, s, sz));
+		mis = bench_str_one(&b, memcpy(d+1, s, sz));
+		set = bench_str_one(&b, memset(d, 0, sz));
+		string_erms = true;
+		rms = bench_str_one(&b, memcpy(d, s, sz));
+		string_erms = erms;
+
+		debug("bench string %lu: %llu %llu %llu %llu %llu cycles\n",
+		      sz, ref, cpy, rms, mis, set);
+	}
+
+	ref = bench_str_one(&b, bench_str_ref(d, s, 8));
+	cpy = bench_str_one(&b, memcpy(d, s, 8));
+	debug("bench string 8 (const): %llu %llu cycles\n", ref, cpy);
+}
+
+/**
+@def BENCH_PAGE_NR
+@brief Pages traitées par mesure (les tampons de bench_string)
+*/
+#define BENCH_PAGE_NR     (BENCH_STR_MAX/PAGE_SIZE)
+
+/**
+@def bench_page_all
+@brief Applique _op_ à chacune des BENCH_PAGE_NR pages (_i_ en index)
+*/
+#define bench_page_all(_i_,_op_)					\
+	for (_i_ = 0; _i_ < BENCH_PAGE_NR; _i_++)			\
+		_op_
+
+/**
+ * @fn static void bench_page()
+ * @brief Cycles par page de page_clear()/page_copy()
+ *
+ * Colonnes : rep stosl/movsl, puis SSE2 movntdq section fpu comprise
+ * (seulement si page_nt). La mesure porte sur BENCH_PAGE_NR pages
+ * consécutives, divisée par BENCH_PAGE_NR.
+ */
+static void bench_page(){
+
+	bool_t   nt = page_nt;
+	uint8_t  *s = bench_str_src, *d = bench_str_dst;
+	uint64_t clr, cpy, clr_nt = 0, cpy_nt = 0;
+	bench_t  b;
+	uint32_t i;
+
+	debug("bench page: rep clear/copy, nt clear/copy (sse2 %u)\n", nt);
+
+	page_nt = false;
+	clr = bench_str_one(&b, bench_page_all(i, page_clear(d+i*PAGE_SIZE)));
+	cpy = bench_str_one(&b, bench_page_all(i,
+			page_copy(d+i*PAGE_SIZE, s+i*PAGE_SIZE)));
+
+	if (nt) {
+		page_nt = true;
+		clr_nt = bench_str_one(&b, bench_page_all(i,
+				page_clear(d+i*PAGE_SIZE)));
+		cpy_nt = bench_str_one(&b, bench_page_all(i,
+				page_copy(d+i*PAGE_SIZE, s+i*PAGE_SIZE)));
+	}
+	page_nt = nt;
+
+	div64(&clr, BENCH_PAGE_NR);
+	div64(&cpy, BENCH_PAGE_NR);
+	div64(&clr_nt, BENCH_PAGE_NR);
+	div64(&cpy_nt, BENCH_PAGE_NR);
+
+	debug("bench page: %llu %llu %llu %llu cycles/page\n",
+	      clr, cpy, clr_nt, cpy_nt);
+}
+
+/**
+ * @fn void bench_run()
+ * @brief Lance l'ensemble des micro-benchmarks
+ *
+ * L'espace d'adressage courant est restauré à la fin.
+ */
+void bench_run(){
+
+	vm_t *vm = vm_current;
+
+	debug("Micro-benchmarks\n");
+	bench_ipc();
+	bench_console();
+	bench_log();
+	bench_format();
+	bench_string();
+	bench_page();
+
+	if (vm)
+		vm_switch(vm);
+}
+
+#endif
@@ -16,32 +16,72 @@
 #include <intr.h>
 #include <pic.h>
 #include <io.h>
+#include <uart.h>
+#include <pmem.h>
+#include <vm.h>
+#include <shm.h>
+#include <ipc.h>
+#include <uaccess.h>
+#include <msr.h>
+#include <asm.h>
+#include <uring.h>
+#include <vdso.h>
+#include <strace.h>
+#include <log.h>
+#include <cpu.h>
+#include <prof.h>
+#include <info.h>
+
+#ifdef CONFIG_BENCH
+void bench_run();
+#endif
 
 /**
  * @struct process
  * @brief Structure représentant un processus
  * 
  * @param pid Identifiant unique du processus
+ * @param vm Espace d'adressage du processus
+ * @param ring Anneau d'appels système asynchrones du processus
+ * @param ring_flags Mode de traitement de l'anneau (URING_SQPOLL)
+ * @param dead Processus arrêté par le noyau, plus jamais ordonnancé
+ * @param wait Processus endormi sur l'anneau de réception du port série
  * @param regs Structure imbriquée contenant l'état des registres du processus
  */
 struct process {
 	unsigned int pid;
+	vm_t *vm;
+	uring_t *ring;          // anneau de soumission (adresse noyau) ou 0
+	uint32_t ring_flags;    // URING_*
+	uint32_t dead;          // arrêté (task_kill)
+	uint32_t wait;          // en attente d'octets reçus (SYS_READ)
 
 	struct {
 		uint32_t eax, ecx, edx, ebx;
 		uint32_t esp, ebp, esi, edi;
 		uint32_t eip, eflags;
 		uint16_t cs, ss;
-		uint32_t cr3;
 	} regs __attribute__ ((packed));
 } __attribute__ ((packed));
 
+/**
+ * @def NR_PROC
+ * @brief Nombre maximal de processus
+ */
+#define NR_PROC      8
+
+/**
+ * @def NR_CLONES
+ * @brief Nombre de processus clonés à partir du modèle user1
+ */
+#define NR_CLONES    2
+
 /**
  * @var p_list
  * @brief Liste des processus du système
  * Tableau statique contenant les processus du système
  */
-struct process p_list[2];
+struct process p_list[NR_PROC];
 
 /**
  * @var current
@@ -55,6 +95,13 @@ struct process *current = 0;
  */
 unsigned int n_proc = 0;
 
+/**
+ * @var resched
+ * @brief Appel système endormi : syscall_isr passe la main à
+ * l'ordonnanceur au lieu de revenir à l'appelant
+ */
+uint32_t resched = 0;
+
 /**
  * @var GDT
  * @brief Global Descriptor Table du système
@@ -69,21 +116,57 @@ seg_desc_t GDT[7];
  */
 tss_t TSS;
 
-/*Une PGD pour chaque processus*/
+/*Un espace d'adressage pour chaque processus*/
+
+/**
+@def USTACK_TOP
+@brief Sommet des piles utilisateur (fin de l'espace utilisateur)
+*/
+#define USTACK_TOP   VM_USER_END
+
+/**
+@def USTACK_SIZE
+@brief Taille réservée pour chaque pile utilisateur, allouée à la demande
+*/
+#define USTACK_SIZE  (64*PAGE_SIZE)
+
+/**
+@var vm_list
+@brief Espaces d'adressage des processus, indexés par pid
+*/
+vm_t vm_list[NR_PROC];
+
+/**
+@def SHM_KEY_COUNTER
+@brief Clé de l'objet de mémoire partagée contenant le compteur
+*/
+#define SHM_KEY_COUNTER  0x636e74
+
+/**
+@def SHM_VA_COUNTER
+@brief Adresse choisie par user1 pour projeter le compteur
+*/
+#define SHM_VA_COUNTER   0x706000
+
+/**
+@def USER1_DATA
+@brief Données privées de user1, présentes avant le clonage : copiées
+sur écriture par chaque clone (page 0 écrite par la tâche, page 1 par
+le noyau avec SYS_PROC_INFO)
+*/
+#define USER1_DATA       0x708000
 
 /**
-@var pgd1
-@brief Page Directory du premier processus
-Pointeur vers la table des pages du processus 1
+@def USER1_DATA_PAGES
+@brief Nombre de pages de USER1_DATA
 */
-pde32_t *pgd1;
+#define USER1_DATA_PAGES 2
 
 /**
-@var pgd2
-@brief Page Directory du deuxième processus
-Pointeur vers la table des pages du processus 2
+@var kstack
+@brief Pile noyau utilisée lors des interruptions en provenance du ring 3
 */
-pde32_t *pgd2;
+uint8_t kstack[PAGE_SIZE] __attribute__((aligned(16)));
 
 
 // ---------------------------------------------------- GDT et TSS ----------------------------------------------------
@@ -258,40 +341,795 @@ void init_gdt() {
 }
 
 // ---------------------------------------------------- Interruption et Appel Système ----------------------------------------------------
+/**
+@def SYS_COUNTER
+@brief Affichage de la valeur d'un compteur (ebx : adresse du compteur)
+*/
+#define SYS_COUNTER      1
+
+/**
+@def SYS_VM_STATS
+@brief Statistiques des fautes de pages
+*/
+#define SYS_VM_STATS     2
+
+/**
+@def SYS_SHM_CREATE
+@brief Création d'un objet partagé (ebx : clé, ecx : taille, edx : drapeaux SHM_*)
+*/
+#define SYS_SHM_CREATE   3
+
+/**
+@def SYS_SHM_MAP
+@brief Projection d'un objet partagé (ebx : identifiant, ecx : adresse ou 0)
+*/
+#define SYS_SHM_MAP      4
+
+/**
+@def SYS_SHM_UNMAP
+@brief Retrait de la projection située à l'adresse ebx
+*/
+#define SYS_SHM_UNMAP    5
+
+/**
+@def SYS_IPC_SEND
+@brief Envoi d'un tampon aligné sur une page (ebx : canal, ecx : adresse, edx : taille, esi : drapeaux IPC_*)
+*/
+#define SYS_IPC_SEND     6
+
+/**
+@def SYS_IPC_RECV
+@brief Réception d'un message (ebx : canal, ecx : adresse ou 0, edx : adresse où écrire la taille)
+*/
+#define SYS_IPC_RECV     7
+
+/**
+@def SYS_GETPID
+@brief Identifiant du processus courant
+*/
+#define SYS_GETPID       8
+
+/**
+@def SYS_BENCH
+@brief Résultat d'une mesure faite en mode utilisateur (make BENCH=1)
+*/
+#define SYS_BENCH        9
+
+/**
+@def SYS_URING_SETUP
+@brief Création de l'anneau d'appels asynchrones (ebx : adresse ou 0, ecx : drapeaux URING_*)
+*/
+#define SYS_URING_SETUP  10
+
+/**
+@def SYS_URING_ENTER
+@brief Exécution des soumissions en attente, rend le nombre traité
+*/
+#define SYS_URING_ENTER  11
+
+/**
+@def SYS_STRACE
+@brief Contrôle de la trace des appels système (ebx : STRACE_OFF, _ON, _DUMP ou _RESET)
+*/
+#define SYS_STRACE       12
+
+/**
+@def SYS_READ
+@brief Lecture bloquante du port série (ebx : tampon, ecx : taille), rend le nombre d'octets lus
+*/
+#define SYS_READ         13
+
+/**
+@def SYS_UART_STATS
+@brief Affichage des compteurs du port série (émission, réception, pertes)
+*/
+#define SYS_UART_STATS   14
+
+/**
+@def SYS_PROF
+@brief Contrôle du profileur par échantillonnage (ebx : PROF_OFF, _ON, _DUMP ou _RESET)
+*/
+#define SYS_PROF         15
+
+/**
+@def SYS_SHM_DESTROY
+@brief Libération d'un objet partagé projeté nulle part (ebx : identifiant)
+*/
+#define SYS_SHM_DESTROY  16
+
+/**
+@def SYS_IPC_UNMAP
+@brief Retrait d'un message reçu par transfert de pages (ebx : adresse, ecx : taille)
+*/
+#define SYS_IPC_UNMAP    17
+
+/**
+@def SYS_PROC_INFO
+@brief Copie du pid et du nombre de processus à l'adresse ebx (2 mots)
+*/
+#define SYS_PROC_INFO    18
+
+/**
+@def NR_SYSCALLS
+@brief Taille de la table des appels système
+*/
+#define NR_SYSCALLS      19
+
+/**
+@def SYSCALL_RESTART
+@brief Valeur rendue par un gestionnaire qui doit être rejoué (appel bloquant)
+
+L'appelant est endormi jusqu'à la prochaine réception sur le port série,
+seule source d'attente, puis rejoue l'appel.
+*/
+#define SYSCALL_RESTART  ((uint32_t)-2)
+
+/**
+@def SYS_READ_MAX
+@brief Nombre maximal d'octets rendus par un SYS_READ
+*/
+#define SYS_READ_MAX     64
+
+/**
+@def BENCH_SYSCALL_RUNS
+@brief Nombre d'appels par mécanisme pour la mesure d'aller-retour
+*/
+#define BENCH_SYSCALL_RUNS  1024
+
+/**
+@def BENCH_URING_BATCH
+@brief Nombre de soumissions par SYS_URING_ENTER pour la mesure
+*/
+#define BENCH_URING_BATCH   32
+
+/**
+@def sep_present()
+@brief Vrai si sysenter/sysexit sont disponibles
+
+Lu dans la copie des fonctionnalités du processeur de la page vdso
+(détection faite une fois par cpu_init(), erratum Pentium Pro compris) :
+utilisable en ring 3 sans exécuter CPUID, qui sort de la VM sous KVM.
+*/
+#define sep_present()    (((vdso_t *)VDSO_VA)->features & (1<<CPU_SEP))
+
+/**
+@def __syscall_int80(nUm,a1,a2,a3,a4,a5)
+@brief Appel système par la porte d'interruption 0x80
+*/
+#define __syscall_int80(_nUm_,_a1_,_a2_,_a3_,_a4_,_a5_) ({              \
+    uint32_t _r_;                                                       \
+    asm volatile ("int $0x80"                                           \
+                  :"=a"(_r_)                                            \
+                  :"a"(_nUm_),"b"(_a1_),"c"(_a2_),"d"(_a3_),            \
+                   "S"(_a4_),"D"(_a5_)                                  \
+                  :"memory");                                           \
+    _r_;                                                                \
+})
+
+/**
+@def __syscall_sysenter(nUm,a1,a2,a3,a4,a5)
+@brief Appel système par sysenter
+
+L'adresse de retour et ebp sont empilés, ebp pointe sur ce cadre :
+sysexit reprend en 1: avec la pile d'origine. ecx et edx sont détruits.
+*/
+#define __syscall_sysenter(_nUm_,_a1_,_a2_,_a3_,_a4_,_a5_) ({           \
+    uint32_t _r_, _c_ = (uint32_t)(_a2_), _d_ = (uint32_t)(_a3_);       \
+    asm volatile ("push $1f          \n"                                \
+                  "push %%ebp        \n"                                \
+                  "mov  %%esp, %%ebp \n"                                \
+                  "sysenter          \n"                                \
+                  "1:                \n"                                \
+                  :"=a"(_r_),"+c"(_c_),"+d"(_d_)                        \
+                  :"a"(_nUm_),"b"(_a1_),"S"(_a4_),"D"(_a5_)             \
+                  :"memory");                                           \
+    _r_;                                                                \
+})
+
+/**
+@def SYSCALL_INIT()
+@brief Choix du mécanisme d'appel système, à placer en tête de chaque tâche
+*/
+#define SYSCALL_INIT()   uint32_t __sys_fast = sep_present()
+
+/**
+@def syscall(nUm,a1,a2,a3,a4,a5)
+@brief Appel système depuis le ring 3 : numéro dans eax, arguments dans
+ebx, ecx, edx, esi, edi, résultat rendu dans eax
+
+Macro et non fonction : le code généré reste dans la section
+de la tâche appelante, seule accessible depuis le ring 3.
+sysenter est utilisé s'il est disponible, int 0x80 sinon.
+*/
+#define syscall(_nUm_,_a1_,_a2_,_a3_,_a4_,_a5_)                         \
+    (__sys_fast ? __syscall_sysenter(_nUm_,_a1_,_a2_,_a3_,_a4_,_a5_)    \
+                : __syscall_int80(_nUm_,_a1_,_a2_,_a3_,_a4_,_a5_))
+
 /**
  * @fn void syscall_isr()
  * @brief Gestionnaire d'interruption pour les appels système
  * 
- * Routine assembleur qui sauvegarde le contexte et appelle syscall_handler
+ * Routine assembleur qui complète le cadre d'interruption en int_ctx_t
+ * (code d'erreur nul, numéro 0x80, registres) et appelle syscall_handler.
+ * Si l'appelant s'est endormi, le cadre d'interruption restant est celui
+ * d'un tick : irq0_handler le reprend pour ordonnancer un autre processus.
  */
 void syscall_isr() {
    asm volatile (
-      "leave ; pusha        \n"
-      "push %eax     \n"
+      "leave                \n"
+      "push $0 ; push $0x80 \n"
+      "pusha                \n"
+      "cld                  \n"
+      "mov %esp, %eax       \n"
       "call syscall_handler \n"
-	  "pop %eax           \n"
-      "popa ; iret"
+      "popa                 \n"
+      "add $8, %esp         \n"
+      "cmpl $0, resched     \n"
+      "jne irq0_handler     \n"
+      "iret"
+      );
+}
+
+/**
+ * @fn void sysenter_isr()
+ * @brief Point d'entrée de sysenter (IA32_SYSENTER_EIP)
+ *
+ * Le processeur arrive ici en ring 0 sur la pile kstack, interruptions
+ * masquées. Un int_ctx_t est construit comme pour int 0x80, les champs
+ * eip/cs/eflags/esp/ss sont remplis par sysenter_handler qui prépare
+ * aussi ecx/edx pour sysexit.
+ */
+void sysenter_isr() {
+   asm volatile (
+      "leave                  \n"
+      "sub $20, %esp          \n"
+      "push $0 ; push $0x80   \n"
+      "pusha                  \n"
+      "cld                    \n"
+      "mov %esp, %eax         \n"
+      "call sysenter_handler  \n"
+      "popa                   \n"
+      "add $28, %esp          \n"
+      "sti ; sysexit"
       );
 }
 
 /**
- * @fn void syscall_handler(int sys_num)
- * @brief Gestionnaire des appels système
- * @param sys_num Numéro de l'appel système
+@def SYSCALL_ARGS
+@brief Paramètres d'un adaptateur syscall_t (ebx, ecx, edx, esi, edi),
+tous marqués inutilisés : chaque adaptateur ne convertit que les siens
+*/
+#define SYSCALL_ARGS     uint32_t __unused__ a1, uint32_t __unused__ a2,    \
+                         uint32_t __unused__ a3, uint32_t __unused__ a4,    \
+                         uint32_t __unused__ a5
+
+/**
+@typedef syscall_t
+@brief Gestionnaire d'appel système : jusqu'à 5 arguments (ebx, ecx, edx, esi, edi)
+*/
+typedef uint32_t (*syscall_t)(uint32_t, uint32_t, uint32_t, uint32_t, uint32_t);
+
+/**
+ * @fn uint32_t syscall_counter(uint32_t *counter)
+ * @brief Affichage de la valeur d'un compteur utilisateur
+ */
+uint32_t syscall_counter(uint32_t *ucounter) {
+
+	uint32_t counter;
+
+	// pointeur utilisateur : une faute devient une erreur
+	if (get_user(&counter, ucounter) < 0)
+		return -1;
+
+	debug("Valeur compteur: %d\n", counter);
+	return 0;
+}
+
+/**
+ * @fn uint32_t syscall_vm_stats()
+ * @brief Statistiques des fautes de pages et du temps processeur par tâche
+ */
+uint32_t syscall_vm_stats() {
+
+	vm_stats();
+	vdso_stats();
+	return 0;
+}
+
+/**
+ * @fn uint32_t syscall_shm_map(int id, offset_t va)
+ * @brief Projection d'un objet partagé dans l'espace courant
+ */
+uint32_t syscall_shm_map(int id, offset_t va) {
+
+	return shm_map(current->vm, id, va);
+}
+
+/**
+ * @fn uint32_t syscall_shm_unmap(offset_t va)
+ * @brief Retrait d'une projection de l'espace courant
+ */
+uint32_t syscall_shm_unmap(offset_t va) {
+
+	return shm_unmap(current->vm, va);
+}
+
+/**
+ * @fn uint32_t syscall_ipc_send(uint32_t chan, offset_t va, size_t len, uint32_t flags)
+ * @brief Envoi d'un tampon sur un canal
+ */
+uint32_t syscall_ipc_send(uint32_t chan, offset_t va, size_t len, uint32_t flags) {
+
+	if (chan >= IPC_NR_CHAN)
+		return -1;
+
+	return ipc_send(&ipc_chans[chan], current->vm, va, len, flags);
+}
+
+/**
+ * @fn uint32_t syscall_ipc_recv(uint32_t chan, offset_t va, uint32_t *ulen)
+ * @brief Réception d'un message, la taille est écrite en ulen
+ */
+uint32_t syscall_ipc_recv(uint32_t chan, offset_t va, uint32_t *ulen) {
+
+	size_t   len;
+	offset_t ret;
+
+	if (chan >= IPC_NR_CHAN)
+		return 0;
+
+	ret = ipc_recv(&ipc_chans[chan], current->vm, va, &len);
+	if (ret && put_user(len, ulen) < 0)
+		return 0;
+
+	return ret;
+}
+
+/**
+ * @fn uint32_t syscall_ipc_unmap(offset_t va, size_t len)
+ * @brief Libération des pages d'un message reçu
+ */
+uint32_t syscall_ipc_unmap(offset_t va, size_t len) {
+
+	return ipc_unmap(current->vm, va, len);
+}
+
+/**
+ * @fn uint32_t syscall_getpid()
+ * @brief Identifiant du processus courant
+ */
+uint32_t syscall_getpid() {
+
+	return current->pid;
+}
+
+/**
+ * @fn uint32_t syscall_proc_info(uint32_t *uinfo)
+ * @brief Écrit le pid et le nombre de processus en uinfo
+ *
+ * copy_to_user vers une page en copie sur écriture : la faute est
+ * prise en ring 0, CR0.WP la fait respecter au noyau.
+ */
+uint32_t syscall_proc_info(uint32_t *uinfo) {
+
+	uint32_t val[2] = { current->pid, n_proc };
+
+	if (!uaccess_ok(uinfo, sizeof(val)))
+		return -1;
+
+	if (copy_to_user(uinfo, val, sizeof(val)))
+		return -1;
+
+	return 0;
+}
+
+#ifdef CONFIG_BENCH
+/**
+ * @fn uint32_t syscall_bench(uint32_t mech, uint32_t runs, uint32_t total, uint32_t min)
+ * @brief Affiche une mesure d'aller-retour faite en mode utilisateur
+ * @param mech 0 : int 0x80, 1 : sysenter, 2 : anneau asynchrone, 3 : page vdso,
+ *             4 : appel le plus rapide avec la trace active
+ */
+uint32_t syscall_bench(uint32_t mech, uint32_t runs, uint32_t total, uint32_t min) {
+
+	static char *names[] = {"int 0x80", "sysenter", "uring", "vdso", "traced"};
+
+	if (mech >= sizeof(names)/sizeof(names[0]))
+		return -1;
+
+	debug("bench syscall %s: %u runs, avg %u min %u cycles\n",
+	      names[mech], runs, runs ? total/runs : 0, min);
+	return 0;
+}
+#endif
+
+static uint32_t uring_exec(uring_sqe_t *sqe);
+
+/**
+ * @fn uint32_t syscall_uring_setup(offset_t va, uint32_t flags)
+ * @brief Projette l'anneau du processus courant, rend son adresse utilisateur
+ *
+ * Avec URING_SQPOLL, l'anneau est aussi vidé à chaque tick par l'ordonnanceur.
+ */
+uint32_t syscall_uring_setup(offset_t va, uint32_t flags) {
+
+	if (current->ring)
+		return 0;
+
+	current->ring = uring_create(current->vm, &va);
+	if (!current->ring)
+		return 0;
+
+	current->ring_flags = flags & URING_SQPOLL;
+	return va;
+}
+
+/**
+ * @fn uint32_t syscall_uring_enter()
+ * @brief Exécute les soumissions en attente du processus courant
+ */
+uint32_t syscall_uring_enter() {
+
+	if (!current->ring)
+		return -1;
+
+	return uring_drain(current->ring, uring_exec);
+}
+
+/**
+ * @fn uint32_t syscall_strace(uint32_t op)
+ * @brief Active, coupe, affiche sur le port série ou remet à zéro la trace
+ */
+uint32_t syscall_strace(uint32_t op) {
+
+	switch (op) {
+	case STRACE_OFF:
+	case STRACE_ON:
+		strace_enable(op);
+		break;
+	case STRACE_DUMP:
+		strace_dump();
+		break;
+	case STRACE_RESET:
+		strace_reset();
+		break;
+	default:
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * @fn uint32_t syscall_prof(uint32_t op)
+ * @brief Démarre, arrête, affiche sur le port série ou remet à zéro le profil
+ */
+uint32_t syscall_prof(uint32_t op) {
+
+	switch (op) {
+	case PROF_OFF:
+	case PROF_ON:
+		prof_enable(op);
+		break;
+	case PROF_DUMP:
+		prof_dump();
+		break;
+	case PROF_RESET:
+		prof_reset();
+		break;
+	default:
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * @fn uint32_t syscall_read(uint8_t *ubuf, uint32_t len)
+ * @brief Lecture des octets reçus sur le port série (au plus SYS_READ_MAX)
+ *
+ * Rien de reçu : SYSCALL_RESTART, l'appelant dort jusqu'à ce que
+ * l'interruption du port série (IRQ4) remplisse l'anneau, puis rejoue l'appel.
+ */
+uint32_t syscall_read(uint8_t *ubuf, uint32_t len) {
+
+	uint8_t kbuf[SYS_READ_MAX];
+	size_t  n;
+
+	if (!len)
+		return 0;
+
+	if (!uaccess_ok(ubuf, len))
+		return -1;
+
+	if (len > sizeof(kbuf))
+		len = sizeof(kbuf);
+
+	n = uart_read(kbuf, len);
+	if (!n)
+		return SYSCALL_RESTART;
+
+	if (copy_to_user(ubuf, kbuf, n))
+		return -1;
+
+	return n;
+}
+
+/**
+ * @fn uint32_t syscall_uart_stats()
+ * @brief Affiche les compteurs d'émission et de réception du port série
+ */
+uint32_t syscall_uart_stats() {
+
+	debug("uart tx: %u queued, %u dropped, %u polled, %u irqs\n",
+	      uart_tx_stats.queued, uart_tx_stats.dropped,
+	      uart_tx_stats.polled, uart_tx_stats.irqs);
+	debug("uart rx: %u received, %u ring overruns, %u fifo overruns, %u errors\n",
+	      uart_rx_stats.received, uart_rx_stats.overruns,
+	      uart_rx_stats.hw_overruns, uart_rx_stats.errors);
+	return 0;
+}
+
+/**
+@brief Adaptateurs syscall_t : chaque gestionnaire est appelé avec son
+propre prototype, jamais à travers un type de fonction différent
+*/
+static uint32_t __sys_counter(SYSCALL_ARGS) { return syscall_counter((uint32_t*)a1); }
+static uint32_t __sys_vm_stats(SYSCALL_ARGS) { return syscall_vm_stats(); }
+static uint32_t __sys_shm_create(SYSCALL_ARGS) { return shm_create(a1, a2, a3); }
+static uint32_t __sys_shm_map(SYSCALL_ARGS) { return syscall_shm_map((int)a1, a2); }
+static uint32_t __sys_shm_unmap(SYSCALL_ARGS) { return syscall_shm_unmap(a1); }
+static uint32_t __sys_ipc_send(SYSCALL_ARGS) { return syscall_ipc_send(a1, a2, a3, a4); }
+static uint32_t __sys_ipc_recv(SYSCALL_ARGS) { return syscall_ipc_recv(a1, a2, (uint32_t*)a3); }
+static uint32_t __sys_getpid(SYSCALL_ARGS) { return syscall_getpid(); }
+#ifdef CONFIG_BENCH
+static uint32_t __sys_bench(SYSCALL_ARGS) { return syscall_bench(a1, a2, a3, a4); }
+#endif
+static uint32_t __sys_uring_setup(SYSCALL_ARGS) { return syscall_uring_setup(a1, a2); }
+static uint32_t __sys_uring_enter(SYSCALL_ARGS) { return syscall_uring_enter(); }
+static uint32_t __sys_strace(SYSCALL_ARGS) { return syscall_strace(a1); }
+static uint32_t __sys_read(SYSCALL_ARGS) { return syscall_read((uint8_t*)a1, a2); }
+static uint32_t __sys_uart_stats(SYSCALL_ARGS) { return syscall_uart_stats(); }
+static uint32_t __sys_prof(SYSCALL_ARGS) { return syscall_prof(a1); }
+static uint32_t __sys_shm_destroy(SYSCALL_ARGS) { return shm_destroy((int)a1); }
+static uint32_t __sys_ipc_unmap(SYSCALL_ARGS) { return syscall_ipc_unmap(a1, a2); }
+static uint32_t __sys_proc_info(SYSCALL_ARGS) { return syscall_proc_info((uint32_t*)a1); }
+
+/**
+@var syscall_table
+@brief Table des appels système, indexée par eax
+*/
+static syscall_t syscall_table[NR_SYSCALLS] = {
+	[SYS_COUNTER]    = __sys_counter,
+	[SYS_VM_STATS]   = __sys_vm_stats,
+	[SYS_SHM_CREATE] = __sys_shm_create,
+	[SYS_SHM_MAP]    = __sys_shm_map,
+	[SYS_SHM_UNMAP]  = __sys_shm_unmap,
+	[SYS_IPC_SEND]   = __sys_ipc_send,
+	[SYS_IPC_RECV]   = __sys_ipc_recv,
+	[SYS_GETPID]     = __sys_getpid,
+#ifdef CONFIG_BENCH
+	[SYS_BENCH]      = __sys_bench,
+#endif
+	[SYS_URING_SETUP] = __sys_uring_setup,
+	[SYS_URING_ENTER] = __sys_uring_enter,
+	[SYS_STRACE]     = __sys_strace,
+	[SYS_READ]       = __sys_read,
+	[SYS_UART_STATS] = __sys_uart_stats,
+	[SYS_PROF]       = __sys_prof,
+	[SYS_SHM_DESTROY] = __sys_shm_destroy,
+	[SYS_IPC_UNMAP]  = __sys_ipc_unmap,
+	[SYS_PROC_INFO]  = __sys_proc_info,
+};
+
+/**
+ * @fn static uint32_t syscall_dispatch(uint32_t sys_num, uint32_t *args)
+ * @brief Appelle le gestionnaire sys_num avec 5 arguments
+ *
+ * Trace active (SYS_STRACE), l'appel est chronométré puis enregistré
+ * dans l'anneau de trace et l'histogramme de son numéro.
+ */
+static uint32_t syscall_dispatch(uint32_t sys_num, uint32_t *args) {
+
+	syscall_t fn;
+	uint64_t  t;
+	uint32_t  ret;
+
+	if (sys_num >= NR_SYSCALLS || !(fn = syscall_table[sys_num])) {
+		debug("Erreur syscall inexistant %u\n", sys_num);
+		return -1;
+	}
+
+	if (!strace_on())
+		return fn(args[0], args[1], args[2], args[3], args[4]);
+
+	t = cpu_rdtsc();
+	ret = fn(args[0], args[1], args[2], args[3], args[4]);
+	strace_record(current->pid, sys_num, args, ret, t, cpu_rdtsc());
+	return ret;
+}
+
+/**
+ * @fn static uint32_t uring_exec(uring_sqe_t *sqe)
+ * @brief Exécute une soumission de l'anneau
+ *
+ * Les appels gérant l'anneau lui-même sont refusés.
+ */
+static uint32_t uring_exec(uring_sqe_t *sqe) {
+
+	uint32_t ret;
+
+	if (sqe->nr == SYS_URING_SETUP || sqe->nr == SYS_URING_ENTER)
+		return -1;
+
+	// un appel bloquant échoue au lieu d'être rejoué
+	ret = syscall_dispatch(sqe->nr, sqe->args);
+	return ret == SYSCALL_RESTART ? (uint32_t)-1 : ret;
+}
+
+/**
+ * @fn static uint32_t syscall_ctx(int_ctx_t *ctx)
+ * @brief Répartiteur des appels système
+ * @param ctx Contexte du processus appelant : numéro dans eax,
+ *            arguments dans ebx, ecx, edx, esi, edi
  * 
- * Implémente les différents appels système:
- * - 1: Affichage de la valeur d'un compteur
+ * Le numéro est vérifié une seule fois, puis le gestionnaire est appelé
+ * depuis syscall_table. Sa valeur de retour est rendue
+ * (-1 pour un appel inexistant).
  */
-void __regparm__(1) syscall_handler(int sys_num) {
+static uint32_t syscall_ctx(int_ctx_t *ctx) {
 
-	uint32_t *counter;
+	uint32_t args[5] = {
+		ctx->gpr.ebx.raw, ctx->gpr.ecx.raw, ctx->gpr.edx.raw,
+		ctx->gpr.esi.raw, ctx->gpr.edi.raw
+	};
 
-	  if (sys_num ==1){
-      	asm volatile("mov  %%ebx, %0":"=m"(counter) :);
-   	  	debug("Valeur compteur: %d\n", *counter);
-	  } else {
-		debug("Erreur syscall inexistant");
-	  }
+	return syscall_dispatch(ctx->gpr.eax.raw, args);
+}
+
+/**
+ * @fn void syscall_handler(int_ctx_t *ctx)
+ * @brief Appel système reçu par int 0x80
+ *
+ * Pour SYSCALL_RESTART, eax garde le numéro et eip recule sur
+ * l'instruction int $0x80 (2 octets) : l'appelant est endormi et
+ * l'appel sera rejoué à son réveil (task_wake).
+ */
+void __regparm__(1) syscall_handler(int_ctx_t *ctx) {
+
+	uint32_t ret = syscall_ctx(ctx);
+
+	if (ret == SYSCALL_RESTART) {
+		ctx->eip.raw -= 2;
+		current->wait = 1;
+		resched = 1;
+	} else
+		ctx->gpr.eax.raw = ret;
+}
+
+/**
+ * @fn static void task_wake()
+ * @brief Réveil des processus endormis sur la réception série
+ *
+ * Appelée par l'interruption du port série (uart_rx_notify) dès que
+ * des octets arrivent : les processus réveillés rejouent leur SYS_READ.
+ */
+static void task_wake() {
+
+	unsigned int i;
+
+	for (i = 0; i < n_proc; i++)
+		p_list[i].wait = 0;
+}
+
+/**
+ * @fn static struct process *task_next(uint32_t wait_ok)
+ * @brief Processus suivant le courant, vivant et prêt
+ * @param wait_ok Accepte aussi un processus endormi
+ * @return Le processus, 0 s'il n'y en a aucun
+ */
+static struct process *task_next(uint32_t wait_ok) {
+
+	struct process *p;
+	uint32_t i;
+
+	for (i = 1; i <= n_proc; i++) {
+		p = &p_list[(current->pid + i) % n_proc];
+		if (!p->dead && (wait_ok || !p->wait))
+			return p;
+	}
+
+	return 0;
+}
+
+/**
+ * @fn static void task_kill()
+ * @brief Arrête le processus courant depuis le noyau (ne revient pas)
+ *
+ * Le processus est marqué mort et la pile noyau repart de son sommet :
+ * un cadre d'interruption ring 3 (sans objet) y est réservé, puis
+ * irq0_handler le prend comme un appel endormi (resched) et schedule()
+ * passe directement au suivant vivant (task_next).
+ */
+static void task_kill() {
+
+	debug("processus %u arrêté\n", current->pid);
+	current->dead = 1;
+	resched = 1;
+
+	TSS.s0.esp = (uint32_t)&kstack[sizeof(kstack)];
+	asm volatile (
+		"mov %0, %%esp     \n"
+		"sub $20, %%esp    \n"
+		"jmp irq0_handler  \n"
+		::"r"(TSS.s0.esp));
+
+	__builtin_unreachable();
+}
+
+/**
+ * @fn void excp_user_kill(int_ctx_t *ctx)
+ * @brief Faute de page utilisateur non résolue (excp_hdlr) : le
+ * processus est arrêté au lieu du noyau
+ */
+void excp_user_kill(int_ctx_t __unused__ *ctx) {
+
+	task_kill();
+}
+
+/**
+ * @fn void sysenter_handler(int_ctx_t *ctx)
+ * @brief Traite un appel système reçu par sysenter
+ * @param ctx Contexte construit par sysenter_isr
+ *
+ * ebp pointe sur le cadre empilé par __syscall_sysenter :
+ * [ebp] ebp d'origine, [ebp+4] adresse de retour. Sans ce cadre il n'y
+ * a ni pile ni adresse où revenir : l'appelant est arrêté.
+ */
+void __regparm__(1) sysenter_handler(int_ctx_t *ctx) {
+
+	uint32_t ebp, eip, ret;
+
+	if (get_user(&ebp, (uint32_t*)ctx->gpr.ebp.raw) < 0 ||
+	    get_user(&eip, (uint32_t*)(ctx->gpr.ebp.raw + 4)) < 0) {
+		debug("sysenter: cadre utilisateur invalide (ebp 0x%x)\n",
+		      ctx->gpr.ebp.raw);
+		task_kill();
+	}
+
+	ctx->eip.raw    = eip;
+	ctx->cs.raw     = c3_sel;
+	ctx->eflags.raw = EFLAGS_IF;
+	ctx->esp.raw    = ctx->gpr.ebp.raw + 8;
+	ctx->ss.raw     = d3_sel;
+	ctx->gpr.ebp.raw = ebp;
+
+	// pas de reprise possible par sysenter (voir sys_read)
+	ret = syscall_ctx(ctx);
+	ctx->gpr.eax.raw = ret == SYSCALL_RESTART ? (uint32_t)-1 : ret;
+
+	ctx->gpr.ecx.raw = ctx->esp.raw;  // esp pour sysexit
+	ctx->gpr.edx.raw = ctx->eip.raw;  // eip pour sysexit
+}
+
+/**
+ * @fn void init_sysenter()
+ * @brief Programme les MSR de sysenter si le processeur les supporte
+ *
+ * sysenter charge cs = c0_sel et ss = c0_sel + 8 (d0_sel),
+ * sysexit cs = c0_sel + 16 (c3_sel) et ss = c0_sel + 24 (d3_sel) :
+ * l'ordre des descripteurs de la GDT en dépend. int 0x80 reste installé.
+ */
+void init_sysenter(){
+
+	if (!cpu_has(CPU_SEP)) {
+		debug("sysenter indisponible, appels système par int 0x80\n");
+		return;
+	}
+
+	wr_msr(IA32_SYSENTER_CS,  c0_sel);
+	wr_msr(IA32_SYSENTER_ESP, (uint32_t)&kstack[sizeof(kstack)]);
+	wr_msr(IA32_SYSENTER_EIP, (uint32_t)sysenter_isr);
 }
 
 /**
@@ -302,16 +1140,24 @@ void __regparm__(1) syscall_handler(int sys_num) {
  * - Sauvegarde le contexte du processus courant
  * - Sélectionne le prochain processus à exécuter
  * - Restaure le contexte du nouveau processus
+ *
+ * Appelé par un tick ou par un appel système endormi (resched) :
+ * dans ce dernier cas les traitements périodiques sont sautés.
  */
 void schedule(void){
    	
 	uint32_t * stack_ptr;
 	uint32_t ss,cs;
    uint32_t esp0;
+   uint32_t tick;
+   struct process *next;
 
 	asm("mov  %%ebp, %%eax;mov  %%eax, %0":"=m"(stack_ptr) :);
 
 	debug("%c", 0);
+
+   tick = !resched;
+   resched = 0;
    
    //Sauvegarde du contexte 
    current->regs.edi = stack_ptr[2];
@@ -327,20 +1173,47 @@ void schedule(void){
    current->regs.esp = stack_ptr[14];
    current->regs.ss = stack_ptr[15];
 
+   //Échantillon du profileur : point interrompu et chaîne d'appels
+   if (tick && !current->dead && prof_on())
+      prof_sample(current->pid, current->regs.eip,
+                  current->regs.cs, current->regs.ebp);
+
    //Nettoyage de la pile 
 	TSS.s0.esp = (uint32_t) (stack_ptr +16);
 	esp0 = TSS.s0.esp;
 
-   //Changement du processus courant 
-	if (n_proc > current->pid+1){
-		current = &p_list[current->pid+1];
-   } else {
-		current = &p_list[0];
+   //Traitement de l'anneau asynchrone du processus sortant (mode URING_SQPOLL)
+   if (!current->dead && current->ring && (current->ring_flags & URING_SQPOLL))
+      uring_drain(current->ring, uring_exec);
+
+   if (tick) {
+      //Horloge de la page vdso (un appel par interruption timer)
+      vdso_tick();
+
+      //Vidage différé du journal noyau vers la console
+      log_flush();
+
+      //Remplissage de la réserve de pages à zéro (entre deux fautes)
+      pmem_refill();
    }
+
+   //Changement du processus courant (suivant vivant et prêt). Si tous
+   //dorment, faute de tâche inactive, le suivant vivant rejoue son appel
+   next = task_next(0);
+   if (!next)
+      next = task_next(1);
+   if (!next)
+      panic("plus aucun processus\n");
+
+   current = next;
 	
    ss = (uint16_t)current->regs.ss;
    cs = (uint16_t)current->regs.cs;
 
+   //Changement d'espace d'adressage (la moitié noyau est commune)
+   vm_switch(current->vm);
+   vdso_switch(current->pid);
+
 
    //Création de la pile du nouveau processus
 	asm volatile (
@@ -379,13 +1252,10 @@ void schedule(void){
       "push %0      \n"
 		"push %1      \n"
 		"push %2      \n"
-      "mov %3, %%eax  \n"
-      "mov %%eax, %%cr3  \n"
 		::
 		"r"(current->regs.ebp),
       "r"(current->regs.esi),
-      "r"(current->regs.edi),
-      "r"(current->regs.cr3)
+      "r"(current->regs.edi)
 	);
 
 }
@@ -407,14 +1277,24 @@ void irq0_handler() {
 }
 
 /**
- * @fn void sys_counter(uint32_t * counter)
- * @brief Appel système pour afficher un compteur
- * @param counter Pointeur vers le compteur à afficher
- */
-void sys_counter(uint32_t * counter){
-      asm volatile("mov  %0, %%ebx;mov $0x01, %%eax":"=m"(counter) :);
-      asm volatile ("int $0x80");
-}
+@def sys_counter(counter)
+@brief Appel système pour afficher un compteur
+@param counter Pointeur vers le compteur à afficher
+
+Macro : le code reste dans la section de la tâche appelante,
+qui doit avoir utilisé SYSCALL_INIT().
+*/
+#define sys_counter(_counter_)  syscall(SYS_COUNTER, _counter_, 0, 0, 0, 0)
+
+/**
+@def sys_read(buf,len)
+@brief Lecture bloquante du port série
+
+Toujours par int 0x80 : tant que rien n'est reçu, le noyau endort
+l'appelant et fait rejouer l'instruction à son réveil (SYSCALL_RESTART). sysenter ne peut pas être rejoué,
+ecx et edx étant détruits au retour.
+*/
+#define sys_read(_buf_,_len_)   __syscall_int80(SYS_READ, _buf_, _len_, 0, 0, 0)
 
 //-----------------------------------------------------Fonction compteurs (Ecriture et Lecture) ----------------------------
 
@@ -423,13 +1303,31 @@ void sys_counter(uint32_t * counter){
  * @brief Incrémentation du compteur - Processus utilisateur 1
  * 
  * Processus qui incrémente un compteur en mémoire partagée
+ * (objet SHM_KEY_COUNTER projeté en SHM_VA_COUNTER), et un compteur
+ * privé dans USER1_DATA : chaque clone en obtient sa copie à la
+ * première écriture (faute de copie sur écriture, ring 3), la page
+ * d'informations étant d'abord écrite par le noyau (ring 0).
  */
 __attribute__((section(".user1.text"))) void user1() {
 	
-	uint32_t *counter = (uint32_t *)0x706000; // Adresse virtuelle dans la zone partagée
+	SYSCALL_INIT();
+	uint32_t *counter;
+	uint32_t *data = (uint32_t *)USER1_DATA;
+	int id;
+
+	// pid et nombre de processus écrits par le noyau dans la page 1
+	syscall(SYS_PROC_INFO, &data[PAGE_SIZE/sizeof(uint32_t)], 0, 0, 0, 0);
+
+	// Création (ou récupération) du compteur, projeté à une adresse choisie
+	id = syscall(SYS_SHM_CREATE, SHM_KEY_COUNTER, PAGE_SIZE, 0, 0, 0);
+	counter = (uint32_t *)syscall(SYS_SHM_MAP, id, SHM_VA_COUNTER, 0, 0, 0);
+	if (!counter)
+		while (1);
+
     while (1) {
         // Incrémente le compteur
       (*counter)++;
+		data[0]++;
 		for(int i = 0; i<50000000; i++);
     }
 }
@@ -438,11 +1336,121 @@ __attribute__((section(".user1.text"))) void user1() {
  * @fn void user2()
  * @brief Affichage du compteur - Processus utilisateur 2
  * 
- * Processus qui lit et affiche la valeur du compteur via un appel système
+ * Processus qui lit et affiche la valeur du compteur via un appel système.
+ * Avec make BENCH=1, mesure d'abord l'aller-retour d'un appel système,
+ * un par un puis par lots dans l'anneau asynchrone.
  */
 __attribute__((section(".user2.text")))  void user2() {
 
-    uint32_t *counter = (uint32_t *)0x806000; // Adresse virtuelle dans la zone partagée
+    SYSCALL_INIT();
+    uint32_t *counter;
+    int id;
+
+#ifdef CONFIG_BENCH
+    // Aller-retour d'un appel système vide, int 0x80 puis sysenter
+    for (uint32_t fast = 0; fast <= __sys_fast; fast++) {
+        uint32_t total = 0, min = ~0U;
+
+        for (int i = 0; i < BENCH_SYSCALL_RUNS; i++) {
+            uint64_t t = rdtsc();
+            uint32_t d;
+
+            if (fast)
+                __syscall_sysenter(SYS_GETPID, 0, 0, 0, 0, 0);
+            else
+                __syscall_int80(SYS_GETPID, 0, 0, 0, 0, 0);
+
+            d = (uint32_t)(rdtsc() - t);
+            total += d;
+            if (d < min)
+                min = d;
+        }
+
+        syscall(SYS_BENCH, fast, BENCH_SYSCALL_RUNS, total, min, 0);
+    }
+
+    // Surcoût de la trace : même appel, trace active, puis affichage
+    {
+        uint32_t total = 0, min = ~0U;
+
+        syscall(SYS_STRACE, STRACE_RESET, 0, 0, 0, 0);
+        syscall(SYS_STRACE, STRACE_ON, 0, 0, 0, 0);
+
+        for (int i = 0; i < BENCH_SYSCALL_RUNS; i++) {
+            uint64_t t = rdtsc();
+            uint32_t d;
+
+            syscall(SYS_GETPID, 0, 0, 0, 0, 0);
+
+            d = (uint32_t)(rdtsc() - t);
+            total += d;
+            if (d < min)
+                min = d;
+        }
+
+        syscall(SYS_STRACE, STRACE_OFF, 0, 0, 0, 0);
+        syscall(SYS_BENCH, 4, BENCH_SYSCALL_RUNS, total, min, 0);
+        syscall(SYS_STRACE, STRACE_DUMP, 0, 0, 0, 0);
+    }
+
+    // Même appel, soumis par lots de BENCH_URING_BATCH dans l'anneau
+    uring_t *ring = (uring_t *)syscall(SYS_URING_SETUP, 0, 0, 0, 0, 0);
+
+    if (ring) {
+        uint32_t total = 0, min = ~0U;
+
+        for (int b = 0; b < BENCH_SYSCALL_RUNS/BENCH_URING_BATCH; b++) {
+            uint64_t t = rdtsc();
+            uint32_t d;
+
+            for (int i = 0; i < BENCH_URING_BATCH; i++) {
+                uring_sqe_t *sqe = uring_sqe_next(ring);
+
+                sqe->nr = SYS_GETPID;
+                sqe->user_data = i;
+                uring_sq_push(ring);
+            }
+
+            syscall(SYS_URING_ENTER, 0, 0, 0, 0, 0);
+
+            while (!uring_cq_empty(ring))
+                uring_cq_pop(ring);
+
+            d = (uint32_t)(rdtsc() - t);
+            total += d;
+            if (d/BENCH_URING_BATCH < min)
+                min = d/BENCH_URING_BATCH;
+        }
+
+        syscall(SYS_BENCH, 2, BENCH_SYSCALL_RUNS, total, min, 0);
+    }
+
+    // Même information, lue sans appel système dans la page vdso
+    {
+        vdso_t *vd = (vdso_t *)VDSO_VA;
+        uint32_t total = 0, min = ~0U;
+
+        for (int i = 0; i < BENCH_SYSCALL_RUNS; i++) {
+            uint64_t t = rdtsc();
+            uint32_t d;
+
+            (void)vdso_getpid(vd);
+
+            d = (uint32_t)(rdtsc() - t);
+            total += d;
+            if (d < min)
+                min = d;
+        }
+
+        syscall(SYS_BENCH, 3, BENCH_SYSCALL_RUNS, total, min, 0);
+    }
+#endif
+
+    // Même objet, projeté à une adresse choisie par le noyau
+    id = syscall(SYS_SHM_CREATE, SHM_KEY_COUNTER, PAGE_SIZE, 0, 0, 0);
+    counter = (uint32_t *)syscall(SYS_SHM_MAP, id, 0, 0, 0, 0);
+    if (!counter)
+        while (1);
 
     while (1) {
       sys_counter(counter);
@@ -450,77 +1458,99 @@ __attribute__((section(".user2.text")))  void user2() {
     }
 }
 
+/**
+ * @fn void user3()
+ * @brief Console sur le port série - Processus utilisateur 3
+ *
+ * Lit les caractères reçus (SYS_READ, bloquant) et pilote le noyau :
+ * 'm' fautes de pages et temps par tâche, 't' active ou coupe la trace
+ * des appels système, 'd' affiche la trace, 'u' compteurs du port série, 'p' démarre ou
+ * arrête le profileur, 'P' affiche ses échantillons.
+ */
+__attribute__((section(".user3.text"))) void user3() {
+
+	SYSCALL_INIT();
+	uint8_t c;
+	uint32_t trace = STRACE_OFF;
+	uint32_t prof = PROF_OFF;
+
+	while (1) {
+		if (sys_read(&c, 1) != 1)
+			continue;
+
+		// pas de switch : sa table de sauts serait dans .rodata (noyau)
+		if (c == 'm')
+			syscall(SYS_VM_STATS, 0, 0, 0, 0, 0);
+		else if (c == 't') {
+			trace = (trace == STRACE_OFF) ? STRACE_ON : STRACE_OFF;
+			syscall(SYS_STRACE, trace, 0, 0, 0, 0);
+		} else if (c == 'd')
+			syscall(SYS_STRACE, STRACE_DUMP, 0, 0, 0, 0);
+		else if (c == 'u')
+			syscall(SYS_UART_STATS, 0, 0, 0, 0, 0);
+		else if (c == 'p') {
+			prof = (prof == PROF_OFF) ? PROF_ON : PROF_OFF;
+			syscall(SYS_PROF, prof, 0, 0, 0, 0);
+		} else if (c == 'P')
+			syscall(SYS_PROF, PROF_DUMP, 0, 0, 0, 0);
+	}
+}
+
 //----------------------------------------------------Initialisation des tables de pages ----------------------------------------
 
+/**
+ * @fn void init_vm(vm_t *vm, offset_t code)
+ * @brief Initialise l'espace d'adressage d'un processus
+ * @param vm Espace d'adressage à initialiser
+ * @param code Adresse (virtuelle et physique) de la page de code
+ *
+ * La pile utilisateur est seulement réservée : ses pages sont
+ * allouées et mises à zéro au premier accès (faute de page).
+ * La page vdso est projetée en lecture seule en VDSO_VA.
+ */
+void init_vm(vm_t *vm, offset_t code){
+
+	vm_init(vm);
+
+	if (vm_map(vm, code, code, PG_USR|PG_RO) < 0 ||
+	    vdso_map(vm) < 0 ||
+	    vm_reserve(vm, USTACK_TOP - USTACK_SIZE, USTACK_SIZE, VM_RGN_RW|VM_RGN_ZERO) < 0)
+		panic("espace d'adressage invalide\n");
+}
+
 /**
  * @fn void init_tables()
  * @brief Initialise les tables de pages des processus
  * 
  * Configure la pagination pour chaque processus:
- * - Tables de pages pour l'espace utilisateur
- * - Tables de pages pour l'espace noyau
- * - Zones de mémoire partagée
+ * - Espace utilisateur [0 - 3GB[ : code et pile à la demande, la zone
+ *   partagée est projetée par les processus eux-mêmes (SYS_SHM_MAP),
+ *   données privées de user1 (USER1_DATA)
+ * - Espace noyau [3GB - 4GB[ : PDE partagées avec le PGD de démarrage
  */
 void init_tables(){
 
-//---------------------------------------------------------Process 1 -----------------------------------------------------------
-	pgd1 = (pde32_t*)0x700000;
-	pte32_t *ptb1 = (pte32_t*)0x701000;
-	pte32_t *ptb_K = (pte32_t*)0x702000;
-
-	for(int i=0;i<1024;i++) {
-	 	pg_set_entry(&pgd1[i], PG_USR|PG_RW, i);
-		pg_set_entry(&ptb1[i], PG_USR|PG_RW, i);
-		pg_set_entry(&ptb_K[i], PG_USR|PG_RW, i);
-	}
-
-
-	pg_set_entry(&pgd1[pd32_get_idx(0x700000)], PG_USR|PG_RW, page_get_nr(ptb1));
-	pg_set_entry(&pgd1[pd32_get_idx(0x900000)], PG_USR|PG_RW, page_get_nr(ptb1));
+	uint32_t i;
 
-	pg_set_entry(&ptb1[pt32_get_idx(0x704000)], PG_USR|PG_RW, page_get_nr(0x704000));
-	pg_set_entry(&ptb1[pt32_get_idx(0x706000)], PG_USR|PG_RW, page_get_nr(0x706000));
-	pg_set_entry(&ptb1[pt32_get_idx(0x900000)], PG_USR|PG_RW, page_get_nr(0x900000));
-	pg_set_entry(&ptb1[pt32_get_idx(0x902000)], PG_USR|PG_RW, page_get_nr(0x902000));
-	pg_set_entry(&ptb1[pt32_get_idx(0x804000)], PG_USR|PG_RW, page_get_nr(0x804000));
-	pg_set_entry(&ptb1[pt32_get_idx(0x806000)], PG_USR|PG_RW, page_get_nr(0x706000));
+	pmem_init();
+	vdso_init();
 
+//---------------------------------------------------------Process 1 -----------------------------------------------------------
+	init_vm(&vm_list[0], 0x704000);
 
-	pg_set_entry(&pgd1[pd32_get_idx(0x300000)], PG_USR|PG_RW, page_get_nr(ptb_K));
-	pg_set_entry(&ptb_K[pt32_get_idx(0x300000)], PG_KRN|PG_RW, page_get_nr(0x300000));
-	pg_set_entry(&ptb_K[pt32_get_idx(0x301000)], PG_KRN|PG_RW, page_get_nr(0x301000));
-	pg_set_entry(&ptb_K[pt32_get_idx(0x302000)], PG_KRN|PG_RW, page_get_nr(0x302000));
-	pg_set_entry(&ptb_K[pt32_get_idx(0x303000)], PG_KRN|PG_RW, page_get_nr(0x303000));
-	pg_set_entry(&ptb1[pt32_get_idx(0x400000)], PG_KRN|PG_RW, page_get_nr(0x400000));
-
+	// données privées présentes avant le clonage (copie sur écriture)
+	for (i = 0; i < USER1_DATA_PAGES; i++) {
+		offset_t pa = pmem_alloc_zero();
 
-	//---------------------------------------------------------Process 2 -----------------------------------------------------------
-	
-	pgd2 = (pde32_t*)0x800000;
-	pte32_t *ptb2 = (pte32_t*)0x801000;
-	pte32_t *ptb_K2 = (pte32_t*)0x802000;
-
-	for(int i=0;i<1024;i++) {
-	 	pg_set_entry(&pgd2[i], PG_USR|PG_RW, i);
-		pg_set_entry(&ptb2[i], PG_USR|PG_RW, i);
-		pg_set_entry(&ptb_K2[i], PG_USR|PG_RW, i);
+		if (!pa || vm_map(&vm_list[0], USER1_DATA + i*PAGE_SIZE, pa, PG_USR|PG_RW) < 0)
+			panic("données de user1\n");
 	}
 
-	pg_set_entry(&pgd2[pd32_get_idx(0x800000)], PG_USR|PG_RW, page_get_nr(ptb2));
-	pg_set_entry(&ptb2[pt32_get_idx(0x804000)], PG_USR|PG_RW, page_get_nr(0x804000));
-	pg_set_entry(&ptb2[pt32_get_idx(0x806000)], PG_USR|PG_RW, page_get_nr(0x706000));
-	pg_set_entry(&ptb2[pt32_get_idx(0x902000)], PG_USR|PG_RW, page_get_nr(0x902000));
-
-	pg_set_entry(&pgd2[pd32_get_idx(0x300000)], PG_USR|PG_RW, page_get_nr(ptb_K2));
-   pg_set_entry(&pgd2[pd32_get_idx(0x400000)], PG_USR|PG_RW, page_get_nr(ptb2));
-
-   pg_set_entry(&ptb_K2[pt32_get_idx(0x300000)], PG_USR|PG_RW, page_get_nr(0x300000));
-   pg_set_entry(&ptb_K2[pt32_get_idx(0x301000)], PG_KRN|PG_RW, page_get_nr(0x301000));
-   pg_set_entry(&ptb_K2[pt32_get_idx(0x302000)], PG_KRN|PG_RW, page_get_nr(0x302000));
-   pg_set_entry(&ptb_K2[pt32_get_idx(0x303000)], PG_KRN|PG_RW, page_get_nr(0x303000));
-	pg_set_entry(&ptb2[pt32_get_idx(0x400000)], PG_KRN|PG_RW, page_get_nr(0x400000)); //Normalement processus 2 ne devrais pas avoir accès à cette pile 
-   pg_set_entry(&ptb2[pt32_get_idx(0x402000)], PG_KRN|PG_RW, page_get_nr(0x402000));
+	//---------------------------------------------------------Process 2 -----------------------------------------------------------
+	init_vm(&vm_list[1], 0x804000);
 
+	//---------------------------------------------------------Process 3 -----------------------------------------------------------
+	init_vm(&vm_list[2], 0x904000);
 }
 
 //--------------------------------------------Initialisation de l'IDTR -------------------------------------------------------
@@ -550,9 +1580,9 @@ void init_tables(){
 //-----------------------------------------Chargement d'un processus----------------------------------------
 
 /**
- * @fn void ChargementTache(uint32_t pgd, uint32_t esp, uint32_t fonction)
+ * @fn void ChargementTache(vm_t *vm, uint32_t esp, uint32_t fonction)
  * @brief Charge un nouveau processus
- * @param pgd Adresse du répertoire de pages du processus
+ * @param vm Espace d'adressage du processus
  * @param esp Pointeur de pile initial
  * @param fonction Point d'entrée du processus
  * 
@@ -561,10 +1591,10 @@ void init_tables(){
  * - Initialisation de la pile
  * - Configuration des segments
  */
-void ChargementTache(uint32_t pgd, uint32_t esp, uint32_t fonction){
+void ChargementTache(vm_t *vm, uint32_t esp, uint32_t fonction){
    
    p_list[n_proc].pid = n_proc;
-	p_list[n_proc].regs.cr3 = pgd;
+	p_list[n_proc].vm = vm;
 	p_list[n_proc].regs.ss = d3_sel;
 	p_list[n_proc].regs.cs = c3_sel;
 	p_list[n_proc].regs.esp = esp;
@@ -575,6 +1605,30 @@ void ChargementTache(uint32_t pgd, uint32_t esp, uint32_t fonction){
 
 }
 
+/**
+ * @fn void ClonageTache(struct process *modele)
+ * @brief Crée un nouveau processus à partir d'un processus modèle
+ * @param modele Processus dont l'espace d'adressage et les registres sont repris
+ *
+ * Seules les tables de pages sont copiées : les pages privées du modèle
+ * passent en copie sur écriture et ne sont dupliquées qu'à la première
+ * écriture de l'un des deux processus.
+ */
+void ClonageTache(struct process *modele){
+
+	if (n_proc >= NR_PROC)
+		panic("trop de processus\n");
+
+	if (vm_clone(&vm_list[n_proc], modele->vm) < 0)
+		panic("clonage de l'espace d'adressage\n");
+
+	p_list[n_proc].pid = n_proc;
+	p_list[n_proc].vm = &vm_list[n_proc];
+	p_list[n_proc].regs = modele->regs;
+
+	n_proc++;
+}
+
 //---------------------------------------Point d'entrée du programme-------------------------------------
 /**
  * @fn void tp()
@@ -584,13 +1638,16 @@ void ChargementTache(uint32_t pgd, uint32_t esp, uint32_t fonction){
  * 1. Initialisation de la GDT
  * 2. Configuration des tables de pages
  * 3. Configuration de l'IDT
- * 4. Chargement des processus utilisateur
- * 5. Activation de la pagination
+ * 4. Chargement des processus utilisateur et clonage de user1
+ * 5. Bascule sur le PGD du premier processus
  * 6. Activation des interruptions
  * 7. Passage en mode utilisateur
  */
  void tp() {
 
+   // "prof" sur la ligne de commande : profileur actif dès le démarrage
+   prof_init(info->mbi);
+
    debug("Initialisation de la GDT\n");
    init_gdt();
    
@@ -600,30 +1657,52 @@ void ChargementTache(uint32_t pgd, uint32_t esp, uint32_t fonction){
    debug("Initialisation de l'IDTR\n");
    init_idtr();
 
-   debug("Chargement des deux processus\n");
-   ChargementTache((uint32_t) pgd1, 0x901000, (uint32_t) &user1);
-   ChargementTache((uint32_t) pgd2, 0x903000, (uint32_t) &user2);
-	
-   debug("Mise à 0 du compteur\n");
-	*(volatile int*)0x706000 = 0;
+   debug("Chargement des trois processus\n");
+   ChargementTache(&vm_list[0], USTACK_TOP, (uint32_t) &user1);
+   ChargementTache(&vm_list[1], USTACK_TOP, (uint32_t) &user2);
+   ChargementTache(&vm_list[2], USTACK_TOP, (uint32_t) &user3);
 
+   debug("Clonage de %d processus à partir de user1\n", NR_CLONES);
+   for (int i = 0; i < NR_CLONES; i++)
+      ClonageTache(&p_list[0]);
+	
    debug("Chargement segment utilisateurs et processus courant\n");
    set_ds(d3_sel);
    set_es(d3_sel);
    set_fs(d3_sel);
    set_gs(d3_sel);
-   TSS.s0.esp = 0x401000;
+   TSS.s0.esp = (uint32_t)&kstack[sizeof(kstack)];
    TSS.s0.ss  = d0_sel;
    tss_dsc(&GDT[ts_idx], (offset_t)&TSS);
 
 	set_tr(ts_sel);
 
+   debug("Initialisation de sysenter\n");
+   init_sysenter();
+
    current = &p_list[0];
 
-    debug("Activiation de la pagination\n");
-   set_cr3((uint32_t)pgd1);
-	uint32_t cr0 = get_cr0(); // enable paging
-	set_cr0(cr0|CR0_PG);
+   // la pagination est activée par le trampoline de démarrage (entry.s),
+   // CR0.WP fait respecter la copie sur écriture au noyau aussi
+   set_cr0(get_cr0()|CR0_WP);
+
+   debug("Passage sur l'espace d'adressage du processus 1\n");
+   vm_switch(current->vm);
+   vdso_switch(current->pid);
+
+#ifdef CONFIG_BENCH
+   if (cpu_has(CPU_TSC))
+      bench_run();
+#endif
+
+   // le port série est vidé et lu par son interruption (IRQ4) à partir d'ici
+   uart_tx_async(UART_TX_BLOCK);
+   uart_rx_async();
+   uart_rx_notify(task_wake);
+
+   // les messages sont journalisés sans attendre la console,
+   // l'ordonnanceur les vide à chaque tick
+   log_defer(true);
 
    debug("Activation des interruptions\n");
    asm volatile("sti");
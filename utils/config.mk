@@ -7,6 +7,7 @@ LD         := $(shell which ld)
 RM         := $(shell which rm)
 FIND       := $(shell which find)
 GIT        := $(shell which git)
+PYTHON     := $(shell which python3)
 RELEASE    := $(shell $(GIT) log -n 1 --no-merges --pretty=format:%h-%t)
 
 # Compilation options
@@ -22,19 +23,35 @@ CFLG_KRN   := -pipe -nostdlib -nostdinc -ffreestanding -fms-extensions -fno-stac
 CFLG_REL   := -DRELEASE=\"secos-$(RELEASE)\"
 CFLAGS     := $(CFLG_WRN) $(CFLG_FP) $(CFLG_KRN) $(CFLG_32) $(CFLG_REL) 
 
+# make BENCH=1 runs micro benchmarks at boot
+ifneq ($(BENCH),)
+CFLAGS     += -DCONFIG_BENCH
+endif
+
 # elementary kernel parts
 INCLUDE    := -I../kernel/include
 CORE       := ../kernel/core/
 
 core_obj   :=	entry.o \
 		start.o \
+		cpu.o \
+		fpu.o \
 		print.o \
+		string.o \
 		uart.o	\
 		pic.o 	\
 		intr.o	\
 		idt.o	\
 		excp.o	\
-		stack.o
+		stack.o	\
+		ksym.o	\
+		page.o	\
+		pmem.o	\
+		vm.o	\
+		uaccess.o	\
+		console.o	\
+		debugcon.o	\
+		log.o
 
 objects    := $(addprefix $(CORE), $(core_obj))
 
@@ -47,12 +64,24 @@ CCLIB      := $(shell $(CC) -m32 -print-libgcc-file-name)
 LDSCRIPT   := ../utils/linker.lds
 TARGET     := kernel.elf
 
+# Embedded symbol table (see rules.mk)
+KSYMGEN    := $(PYTHON) ../utils/ksymgen.py
+KSYM       := ksym_table
+
 # Qemu options
 QEMU := $(shell which qemu-system-i386)
 #QEMU := $(shell which kvm)
 QFDA := -drive media=disk,format=raw,if=floppy,file=../utils/grub.floppy
 QHDD := -drive media=disk,format=raw,if=ide,index=0,file=fat:rw:.
 QSRL := -serial mon:stdio
+
+# make DEBUGCON=1 qemu: printf() goes to the debug port (0xE9),
+# multiplexed with the serial port and the monitor on stdio
+ifneq ($(DEBUGCON),)
+CFLAGS     += -DCONFIG_DEBUGCON
+QSRL := -chardev stdio,id=con,mux=on \
+        -serial chardev:con -mon chardev=con -debugcon chardev:con
+endif
 QDBG := -d int,pcall,cpu_reset,unimp,guest_errors
 QOPT := $(QFDA) $(QHDD) $(QSRL) -boot a -nographic
 
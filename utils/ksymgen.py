@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+# GPLv2 (c) Airbus
+"""
+Emit the symbol table of a kernel image as an assembler
+source for its .ksym section (see kernel/core/ksym.c).
+
+    ksymgen.py kernel.elf > ksym.s
+
+Code symbols are sorted by address, every executable section
+ends with an unnamed entry. Names are prefix compressed: one
+byte of length shared with the previous name, then the rest
+of the name, nul terminated. Every KSYM_BLOCK-th name is
+stored whole and its offset goes to __ksym_block__.
+"""
+import struct
+import sys
+
+KSYM_BLOCK = 16
+KSYM_NAME_MAX = 64
+
+SHF_ALLOC = 0x2
+SHF_EXECINSTR = 0x4
+STT_NOTYPE, STT_FUNC = 0, 2
+STB_GLOBAL = 1
+
+
+def code_symbols(path):
+    with open(path, "rb") as f:
+        elf = f.read()
+
+    if elf[:4] != b"\x7fELF" or elf[4] != 1:
+        sys.exit("%s: not an ELF32 file" % path)
+
+    shoff, = struct.unpack_from("<I", elf, 0x20)
+    shentsize, shnum = struct.unpack_from("<HH", elf, 0x2e)
+    shdrs = [struct.unpack_from("<IIIIIIIIII", elf, shoff + i*shentsize)
+             for i in range(shnum)]
+
+    code = {i: sh for i, sh in enumerate(shdrs)
+            if sh[2] & (SHF_ALLOC | SHF_EXECINSTR) == SHF_ALLOC | SHF_EXECINSTR
+            and sh[5]}
+
+    symtab = [sh for sh in shdrs if sh[1] == 2]            # SHT_SYMTAB
+    if not symtab:
+        sys.exit("%s: no .symtab section" % path)
+
+    sh = symtab[0]
+    strtab = shdrs[sh[6]]
+    best = {}
+    for off in range(sh[4], sh[4] + sh[5], 16):
+        name, value, size, info, other, shndx = \
+            struct.unpack_from("<IIIBBH", elf, off)
+        kind, bind = info & 0xf, info >> 4
+        if shndx not in code or kind not in (STT_NOTYPE, STT_FUNC):
+            continue
+
+        name = elf[strtab[4] + name:].split(b"\0", 1)[0]
+        if not name or name.startswith(b".L"):
+            continue
+
+        # aliases: functions before labels, globals before locals
+        rank = (kind == STT_FUNC, bind == STB_GLOBAL)
+        if value not in best or rank > best[value][0]:
+            best[value] = (rank, name[:KSYM_NAME_MAX-1])
+
+    syms = {value: name for value, (rank, name) in best.items()}
+    for sh in code.values():
+        syms.setdefault(sh[3] + sh[5], b"")
+
+    return sorted(syms.items())
+
+
+def compress(names):
+    out, blocks, prev = bytearray(), [], b""
+
+    for i, name in enumerate(names):
+        shared = 0
+        if i % KSYM_BLOCK:
+            while shared < min(len(prev), len(name), 255) and \
+                  prev[shared] == name[shared]:
+                shared += 1
+        else:
+            blocks.append(len(out))
+
+        out += bytes([shared]) + name[shared:] + b"\0"
+        prev = name
+
+    return out, blocks
+
+
+def longs(values):
+    return ["   .long " + ", ".join("0x%x" % v for v in values[i:i+6])
+            for i in range(0, len(values), 6)]
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit(__doc__.strip())
+
+    syms = code_symbols(sys.argv[1])
+    names, blocks = compress([name for value, name in syms])
+
+    lines = ["/* generated by ksymgen.py, %u symbols, %u bytes of names */"
+             % (len(syms), len(names)),
+             "   .section .ksym,\"a\"",
+             "   .align 4",
+             "   .globl __ksym_nr__, __ksym_addr__, __ksym_block__, __ksym_names__",
+             "__ksym_nr__:",
+             "   .long %u" % len(syms),
+             "__ksym_addr__:"]
+    lines += longs([value for value, name in syms])
+    lines += ["__ksym_block__:"]
+    lines += longs(blocks)
+    lines += ["__ksym_names__:"]
+    lines += ["   .byte " + ", ".join("%u" % b for b in names[i:i+16])
+              for i in range(0, len(names), 16)]
+
+    print("\n".join(lines))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+# GPLv2 (c) Airbus
+"""
+Decode log_fast() records from a captured console stream.
+
+    logdecode.py kernel.elf [console.log] [-t]
+
+Records are "#L seq tsc_hi tsc_lo id words..." lines (hex). The
+format string is read at offset "id" of the .logfmt section of the
+kernel image, the words are formatted the way the kernel printf()
+would. Other lines are copied unchanged. -t prefixes decoded lines
+with their sequence number and TSC.
+"""
+import re
+import struct
+import sys
+
+TAG = "#L"
+
+# kernel printf conversions, words consumed for each length
+CONV = re.compile(r"%([-0 ]*)(\d*)(?:\.(\d+))?(hh|h|ll|l)?([diuxXDcspbB%])")
+
+
+def logfmt_section(path):
+    with open(path, "rb") as f:
+        elf = f.read()
+
+    if elf[:4] != b"\x7fELF" or elf[4] != 1:
+        sys.exit("%s: not an ELF32 file" % path)
+
+    shoff, = struct.unpack_from("<I", elf, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from("<HHH", elf, 0x2e)
+
+    def shdr(i):
+        return struct.unpack_from("<IIIIIIIIII", elf, shoff + i*shentsize)
+
+    strtab = shdr(shstrndx)
+    for i in range(shnum):
+        sh = shdr(i)
+        name = elf[strtab[4] + sh[0]:].split(b"\0", 1)[0]
+        if name == b".logfmt":
+            return elf[sh[4]:sh[4] + sh[5]]
+
+    sys.exit("%s: no .logfmt section" % path)
+
+
+def fmt_string(section, off):
+    return section[off:].split(b"\0", 1)[0].decode("latin-1")
+
+
+def format_record(fmt, words):
+    words = list(words)
+
+    def take(n):
+        v = 0
+        for i in range(n):
+            v |= (words.pop(0) if words else 0) << (32*i)
+        return v
+
+    def sub(m):
+        flags, width, prec, length, conv = m.groups()
+        if conv == "%":
+            return "%"
+
+        n = 2 if length == "ll" or conv in "DXB" else 1
+        v = take(n)
+        bits = 32*n
+
+        if conv in "di" or conv == "D":
+            if v >> (bits-1):
+                v -= 1 << bits
+            s = "%d" % v
+        elif conv == "u":
+            s = "%u" % v
+        elif conv in "xX":
+            s = "%x" % v
+        elif conv == "p":
+            s = "0x%x" % v
+        elif conv == "c":
+            s = chr(v & 0xff)
+        elif conv in "bB":
+            s = format(v, "0%db" % bits)
+        else:
+            s = "<str@0x%x>" % v
+
+        if prec and conv in "diuxXDp":
+            s = s.rjust(int(prec), "0")
+        if width:
+            pad = "0" if "0" in flags and "-" not in flags else " "
+            s = s.ljust(int(width)) if "-" in flags else s.rjust(int(width), pad)
+        return s
+
+    return CONV.sub(sub, fmt)
+
+
+def main():
+    args = [a for a in sys.argv[1:] if a != "-t"]
+    stamps = "-t" in sys.argv[1:]
+
+    if not args:
+        sys.exit(__doc__.strip())
+
+    section = logfmt_section(args[0])
+    stream = open(args[1], errors="replace") if len(args) > 1 else sys.stdin
+
+    for line in stream:
+        pos = line.find(TAG + " ")
+        if pos < 0:
+            sys.stdout.write(line)
+            continue
+
+        sys.stdout.write(line[:pos])
+        try:
+            f = [int(x, 16) for x in line[pos+len(TAG):].split()]
+            seq, tsc, off, words = f[0], (f[1] << 32) | f[2], f[3], f[4:]
+        except (ValueError, IndexError):
+            sys.stdout.write(line[pos:])
+            continue
+
+        msg = format_record(fmt_string(section, off), words)
+        if stamps:
+            msg = "[%u %u] %s" % (seq, tsc, msg)
+        sys.stdout.write(msg)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+# GPLv2 (c) Airbus
+"""
+Turn prof_dump() samples from a captured console stream into
+folded stacks, the input of flamegraph.pl.
+
+    profsym.py kernel.elf [console.log]
+
+Samples are "#P pid cpl pc caller..." lines (hex). Addresses are
+looked up in the .symtab of the kernel image, the user tasks live
+in the same image. Each stack starts with the task ("pid N"),
+frames of kernel samples get the "_[k]" suffix.
+"""
+import bisect
+import collections
+import struct
+import sys
+
+TAG = "#P"
+STT_FUNC = 2
+
+
+def functions(path):
+    with open(path, "rb") as f:
+        elf = f.read()
+
+    if elf[:4] != b"\x7fELF" or elf[4] != 1:
+        sys.exit("%s: not an ELF32 file" % path)
+
+    shoff, = struct.unpack_from("<I", elf, 0x20)
+    shentsize, shnum = struct.unpack_from("<HH", elf, 0x2e)
+
+    def shdr(i):
+        return struct.unpack_from("<IIIIIIIIII", elf, shoff + i*shentsize)
+
+    for i in range(shnum):
+        sh = shdr(i)
+        if sh[1] != 2:                          # SHT_SYMTAB
+            continue
+
+        strtab = shdr(sh[6])
+        syms = []
+        for off in range(sh[4], sh[4] + sh[5], 16):
+            name, value, size, info = struct.unpack_from("<IIIB", elf, off)
+            if info & 0xf != STT_FUNC or not value:
+                continue
+            name = elf[strtab[4] + name:].split(b"\0", 1)[0].decode()
+            syms.append((value, size, name))
+
+        syms.sort()
+        return syms
+
+    sys.exit("%s: no .symtab section" % path)
+
+
+def symbolize(syms, addrs, pc):
+    i = bisect.bisect_right(addrs, pc) - 1
+    if i >= 0:
+        value, size, name = syms[i]
+        if pc < value + max(size, 1):
+            return name
+    return "0x%x" % pc
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit(__doc__.strip())
+
+    syms = functions(sys.argv[1])
+    addrs = [s[0] for s in syms]
+    stream = open(sys.argv[2], errors="replace") if len(sys.argv) > 2 else sys.stdin
+    stacks = collections.Counter()
+
+    for line in stream:
+        pos = line.find(TAG + " ")
+        if pos < 0:
+            continue
+
+        try:
+            f = [int(x, 16) for x in line[pos+len(TAG):].split()]
+            pid, cpl, pcs = f[0], f[1], f[2:]
+        except (ValueError, IndexError):
+            continue
+
+        if not pcs:
+            continue
+
+        # callers are return addresses: look up the call instruction
+        names = [symbolize(syms, addrs, pc if i == 0 else pc - 1)
+                 for i, pc in enumerate(pcs)]
+        if cpl == 0:
+            names = [n + "_[k]" for n in names]
+
+        stacks[";".join(["pid %u" % pid] + names[::-1])] += 1
+
+    for stack, count in sorted(stacks.items()):
+        print("%s %u" % (stack, count))
+
+
+if __name__ == "__main__":
+    main()
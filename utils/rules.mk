@@ -20,7 +20,23 @@ endef
 
 define link
 echo "    LD    $@"
-$(LD) $(LDFLAGS) --gc-sections -T $(LDSCRIPT) $^ -o $@ $(CCLIB)
+$(LD) $(LDFLAGS) --gc-sections -T $(LDSCRIPT) $(1) -o $@ $(CCLIB)
+endef
+
+#
+# The kernel is linked twice: the code symbols of the first
+# image go to the .ksym section of the second one. Both must
+# agree, the table of the result is checked against it.
+#
+define ksym
+echo "    KSYM  $@"
+$(KSYMGEN) $@ > $(KSYM).s
+$(CC) $(CFLAGS) -o $(KSYM).o -c $(KSYM).s
+endef
+
+define ksym_check
+$(KSYMGEN) $@ | cmp -s - $(KSYM).s || \
+   (echo "$@: symbols moved by .ksym"; $(RM) -f $@; false)
 endef
 
 define qemu
@@ -47,12 +63,15 @@ endef
 all:$(TARGET)
 
 $(TARGET): $(objects)
-	@$(link)
+	@$(call link,$^)
+	@$(ksym)
+	@$(call link,$^ $(KSYM).o)
+	@$(ksym_check)
 
 dependencies := $(objects:.o=.d)
 
 clean:
-	@$(RM) -f $(TARGET) $(objects) $(dependencies)
+	@$(RM) -f $(TARGET) $(objects) $(dependencies) $(KSYM).s $(KSYM).o
 
 qemu: $(TARGET)
 	@$(qemu)